@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Throughput benchmark of exampleB5
+
+Runs each fixed scenario macro (bench/b5bench_<scenario>.mac) with a fixed
+seed at 1, N/2 and N threads and prints events/s, us/event, peak RSS and
+output bytes/event as JSON. With --compare, the events/s are compared with
+a previous result and the exit code is 1 if any point is slower by more
+than the tolerance.
+
+Usage: bench/b5bench.py [--exe exampleB5] [--threads N] [--events 2000]
+                        [--seed 12345] [--scenarios a,b] [--output file]
+                        [--compare baseline.json] [--tolerance 0.05]
+The b5bench CMake target runs it with the built executable.
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+SCENARIOS = ["single_eplus", "hadron_shower", "bunch3", "tracking_only"]
+
+# printed by B5RunAction at the end of the global run
+RATE = re.compile(r"(\d+) events in ([-+.\deE]+) s : ([-+.\deE]+) events/s")
+
+
+def git_commit(directory):
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "--short", "HEAD"], cwd=directory,
+            stderr=subprocess.DEVNULL, universal_newlines=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def run_point(exe, scenario, threads, events, seed, work):
+    """Runs one scenario and returns its measurements."""
+    prefix = os.path.join(work, "%s_t%d" % (scenario, threads))
+    os.makedirs(prefix)
+    command = [exe, "-m", "bench/b5bench_%s.mac" % scenario,
+               "-t", str(threads), "-n", str(events), "-s", str(seed),
+               "-o", os.path.join(prefix, "B5")]
+    with open(prefix + ".log", "w") as log:
+        start = time.time()
+        process = subprocess.Popen(command, stdout=log,
+                                   stderr=subprocess.STDOUT)
+        # the resource usage of this child only
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.time() - start
+    with open(prefix + ".log") as log:
+        rates = RATE.findall(log.read())
+    if status != 0 or not rates:
+        sys.exit("b5bench: %s failed, see %s.log" % (" ".join(command),
+                                                    prefix))
+
+    nof_events, seconds, rate = int(rates[-1][0]), float(rates[-1][1]), \
+        float(rates[-1][2])
+    output_bytes = sum(os.path.getsize(os.path.join(prefix, name))
+                       for name in os.listdir(prefix))
+    # ru_maxrss is in kB on Linux, in bytes on macOS
+    rss_mb = usage.ru_maxrss / (1024. * 1024. if sys.platform == "darwin"
+                                else 1024.)
+    return {
+        "scenario": scenario,
+        "threads": threads,
+        "events": nof_events,
+        "seconds": seconds,
+        "wall_seconds": round(wall, 3),
+        "events_per_s": rate,
+        "us_per_event": 1e6 / rate if rate > 0 else None,
+        "peak_rss_mb": round(rss_mb, 1),
+        "output_bytes": output_bytes,
+        "bytes_per_event": output_bytes / nof_events if nof_events else None,
+    }
+
+
+def compare(results, baseline_file, tolerance):
+    """Prints the events/s relative to the baseline, returns the number
+    of regressions."""
+    with open(baseline_file) as baseline:
+        reference = {(r["scenario"], r["threads"]): r["events_per_s"]
+                     for r in json.load(baseline)["results"]}
+    regressions = 0
+    for result in results:
+        key = (result["scenario"], result["threads"])
+        if key not in reference or not reference[key]:
+            continue
+        ratio = result["events_per_s"] / reference[key]
+        slower = ratio < 1. - tolerance
+        regressions += slower
+        print("%-14s %3d threads: %10.1f events/s, %+6.1f %%%s"
+              % (key[0], key[1], result["events_per_s"], 100. * (ratio - 1.),
+                 "  REGRESSION" if slower else ""), file=sys.stderr)
+    return regressions
+
+
+def main():
+    source = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--exe", default="./exampleB5")
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 1,
+                        help="N, the largest number of threads")
+    parser.add_argument("--events", type=int, default=2000)
+    parser.add_argument("--seed", type=int, default=12345)
+    parser.add_argument("--scenarios", default=",".join(SCENARIOS))
+    parser.add_argument("--output", help="also write the JSON to this file")
+    parser.add_argument("--compare", help="JSON of a previous run")
+    parser.add_argument("--tolerance", type=float, default=0.05)
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    threads = sorted({1, max(1, args.threads // 2), args.threads})
+
+    # the macros are given relative to the source directory
+    os.chdir(source)
+    results = []
+    with tempfile.TemporaryDirectory(prefix="b5bench") as work:
+        for scenario in args.scenarios.split(","):
+            for nof_threads in threads:
+                result = run_point(exe, scenario, nof_threads, args.events,
+                                   args.seed, work)
+                print("%-14s %3d threads: %10.1f events/s %10.1f us/event"
+                      % (scenario, nof_threads, result["events_per_s"],
+                         result["us_per_event"] or 0.), file=sys.stderr)
+                results.append(result)
+
+    report = json.dumps({
+        "commit": git_commit(source),
+        "host": platform.node(),
+        "cpus": os.cpu_count(),
+        "events": args.events,
+        "seed": args.seed,
+        "results": results,
+    }, indent=2)
+    print(report)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(report + "\n")
+
+    if args.compare and compare(results, args.compare, args.tolerance):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# Output compression benchmark
+#
+# Runs the reference macro once, then rewrites its output with each
+# compression setting and reports write MB/s, read MB/s (uncompressed)
+# and bytes/event.
+#
+# Usage: bench/compression.sh [exampleB5] [macro] [settings...]
+#   settings are ROOT compression settings, algorithm*100 + level:
+#   101 (zlib 1), 106 (zlib 6), 207 (lzma 7), 404 (lz4 4), 505 (zstd 5)
+#   The basket size and number of entries can be set in the macro with
+#   /B5/output/basketSize and /B5/output/autoFlush.
+#
+set -e
+
+exe=${1:-./exampleB5}
+macro=${2:-bench/compression.mac}
+[ $# -gt 2 ] && shift 2 && settings="$*"
+settings=${settings:-"0 101 106 207 404 505"}
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# reference output, uncompressed
+"$exe" -m "$macro" -o "$work/ref" > "$work/sim.log"
+hadd -f0 "$work/ref0.root" "$work/ref.root" > /dev/null
+
+set -- $(root -l -b -q "$here/read_b5.C(\"$work/ref0.root\")" \
+         | awk '/^read_b5/ { print $2, $3 }')
+events=$1
+raw=$2
+
+printf "%-10s %12s %12s %12s %14s\n" \
+       setting "write MB/s" "read MB/s" "bytes/event" "file bytes"
+for setting in $settings; do
+  out="$work/out_$setting.root"
+  start=$(date +%s.%N)
+  hadd -f"$setting" "$out" "$work/ref0.root" > /dev/null
+  end=$(date +%s.%N)
+  read_time=$(root -l -b -q "$here/read_b5.C(\"$out\")" \
+              | awk '/^read_b5/ { print $4 }')
+  size=$(wc -c < "$out")
+  awk -v s="$setting" -v raw="$raw" -v events="$events" -v size="$size" \
+      -v start="$start" -v end="$end" -v rt="$read_time" 'BEGIN {
+    wt = end - start
+    printf "%-10s %12.1f %12.1f %12.1f %14d\n", s,
+           raw/1e6/wt, raw/1e6/rt, size/events, size }'
+done
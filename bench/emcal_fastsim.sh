@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# EM calorimeter fast simulation benchmark
+#
+# Runs the same e+ events with full simulation, with full simulation and
+# the fast simulation process registered (--fastsim, model off: the cost
+# of the process alone) and with the GFlash parameterisation 
+# (/B5/fastsim/emcal), then compares the events/s and the calorimeter 
+# energy distributions of the full and fast simulations.
+#
+# Usage: bench/emcal_fastsim.sh [exampleB5] [nThreads]
+#
+set -e
+
+exe=$(cd "$(dirname "${1:-./exampleB5}")" && pwd)/$(basename "${1:-exampleB5}")
+threads=${2:-1}
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# the macros refer to each other relative to the source directory
+cd "$here/.."
+
+for mode in full registered fast; do
+  case $mode in
+    full)       options="-m bench/emcal_full.mac" ;;
+    registered) options="-m bench/emcal_full.mac --fastsim" ;;
+    fast)       options="-m bench/emcal_fast.mac --fastsim" ;;
+  esac
+  "$exe" $options -t "$threads" -o "$work/$mode" > "$work/$mode.log"
+  if [ ! -f "$work/$mode.root" ]; then
+    echo "emcal_fastsim.sh: no output for the $mode mode, see its log:" >&2
+    tail -20 "$work/$mode.log" >&2
+    exit 1
+  fi
+  rate=$(awk '/events\/s$/ && /events in/ { print $(NF-1) }' "$work/$mode.log" \
+         | tail -1)
+  printf "%-10s %12s events/s\n" "$mode" "$rate"
+done
+
+root -l -b -q "$here/compare_emcal.C(\"$work/full.root\",\"$work/fast.root\")"
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Region production cuts benchmark
+#
+# Runs the same pi+ events with the default cut, with fine tracker and
+# coarse absorber cuts (/B5/region/cut) and with coarse cuts everywhere,
+# then compares the events/s with the chamber hits and the calorimeter
+# energies.
+#
+# Usage: bench/regioncuts.sh [exampleB5] [nThreads]
+#
+set -e
+
+exe=$(cd "$(dirname "${1:-./exampleB5}")" && pwd)/$(basename "${1:-exampleB5}")
+threads=${2:-1}
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# the macros refer to each other relative to the source directory
+cd "$here/.."
+
+for config in default tuned coarse; do
+  "$exe" -m "bench/regioncuts_$config.mac" -t "$threads" -o "$work/$config" \
+    > "$work/$config.log"
+  rate=$(awk '/events\/s$/ && /events in/ { print $(NF-1) }' "$work/$config.log" \
+         | tail -1)
+  printf "%-8s %12s events/s\n" "$config" "$rate"
+done
+
+root -l -b -q "$here/compare_regioncuts.C(\"$work\")"
@@ -28,74 +28,238 @@
 /// \brief Main program of the analysis/B5 example
 
 #include "B5DetectorConstruction.hh"
+#include "B5FastShowerSetup.hh"
 #include "B5ActionInitialization.hh"
 
-#ifdef G4MULTITHREADED
-#include "G4MTRunManager.hh"
-#else
-#include "G4RunManager.hh"
-#endif
+#include "G4RunManagerFactory.hh"
+#include "G4Threading.hh"
 
 #include "G4UImanager.hh"
+#include "G4StateManager.hh"
 #include "FTFP_BERT.hh"
 #include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "Randomize.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " exampleB5 [-m macro] [-t nThreads] [-n nEvents] [-o output]"
+           << " [-s seed] [--no-vis] [--per-worker-files] [--fastsim]" 
+           << G4endl;
+    G4cerr << " exampleB5 macro" << G4endl;
+    G4cerr << "   note: -t option is available only for multi-threaded mode;"
+           << " '-t max' uses all cores, the B5_NTHREADS environment"
+           << " variable is used when -t is not given." << G4endl;
+    G4cerr << "   note: --per-worker-files writes one analysis file per worker"
+           << " instead of merging the ntuple on master." << G4endl;
+    G4cerr << "   note: --fastsim registers the fast simulation process"
+           << " needed by /B5/fastsim/emcal on." << G4endl;
+    G4cerr << "   note: with a macro or -n the job runs in batch mode,"
+           << " without visualization and UI session." << G4endl;
+  }
+
+  // Parse a whole decimal integer in [min, max]
+  G4bool ParseInteger(const G4String& value, long min, long max, 
+                      long& result) {
+    if ( value.empty() ) return false;
+    char* end = nullptr;
+    errno = 0;
+    auto number = std::strtol(value.c_str(), &end, 10);
+    if ( errno != 0 || *end != '\0' || number < min || number > max ) {
+      return false;
+    }
+    result = number;
+    return true;
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  auto startTime = std::chrono::steady_clock::now();
+
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4String output;
+  G4int nofEvents = -1;
+  long seed = -1;
+  G4bool useVis = true;
+  G4bool perWorkerFiles = false;
+  G4bool fastSimulation = false;
+  G4String threads;
+  if ( argc == 2 && argv[1][0] != '-' ) {
+    // legacy usage: exampleB5 macro
+    macro = argv[1];
+  }
+  else {
+    for ( G4int i = 1; i < argc; ++i ) {
+      G4String arg = argv[i];
+      if ( arg == "--no-vis" ) {
+        useVis = false;
+        continue;
+      }
+      if ( arg == "--per-worker-files" ) {
+        perWorkerFiles = true;
+        continue;
+      }
+      if ( arg == "--fastsim" ) {
+        fastSimulation = true;
+        continue;
+      }
+      if ( i + 1 >= argc ) {
+        PrintUsage();
+        return 1;
+      }
+      G4String value = argv[++i];
+      long number = 0;
+      G4bool valid = true;
+      if      ( arg == "-m" ) macro = value;
+      else if ( arg == "-o" ) output = value;
+      else if ( arg == "-t" ) threads = value;
+      else if ( arg == "-n" ) {
+        valid = ParseInteger(value, 0, INT_MAX, number);
+        nofEvents = number;
+      }
+      else if ( arg == "-s" ) {
+        valid = ParseInteger(value, 0, LONG_MAX, number);
+        seed = number;
+      }
+      else valid = false;
+      if ( ! valid ) {
+        G4cerr << " Invalid argument: " << arg << " " << value << G4endl;
+        PrintUsage();
+        return 1;
+      }
+    }
+  }
+
+  // Batch jobs never construct the UI session nor the vis manager
+  G4bool batchMode = ( macro.size() || nofEvents >= 0 );
+  if ( batchMode ) useVis = false;
+
+  // Detect interactive mode and define UI session
   //
-  G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  G4UIExecutive* ui = nullptr;
+  if ( ! batchMode ) {
     ui = new G4UIExecutive(argc, argv);
   }
 
-  // Construct the default run manager
+  // Random seed
+  if ( seed >= 0 ) G4Random::setTheSeed(seed);
+
+  // Number of threads: command line, then B5_NTHREADS, 
+  // then the Geant4 default
+  if ( threads.empty() && std::getenv("B5_NTHREADS") ) {
+    threads = std::getenv("B5_NTHREADS");
+  }
+  G4int nofThreads = 0;
+  if ( threads == "max" ) {
+    nofThreads = G4Threading::G4GetNumberOfCores();
+  }
+  else if ( threads.size() ) {
+    long number = 0;
+    if ( ! ParseInteger(threads, 1, INT_MAX, number) ) {
+      G4cerr << " Invalid number of threads: " << threads << G4endl;
+      PrintUsage();
+      delete ui;
+      return 1;
+    }
+    nofThreads = number;
+  }
+
+  // Construct the run manager: task-based when Geant4 is built with 
+  // multi-threading, sequential otherwise
+  // (G4RUN_MANAGER_TYPE in the environment overrides the type)
   //
-#ifdef G4MULTITHREADED
-  auto runManager = new G4MTRunManager;
-#else
-  auto runManager = new G4RunManager;
-#endif
+  G4bool failIfUnavailable = false;
+  auto runManager 
+    = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Tasking, 
+                                            failIfUnavailable, nofThreads);
 
   // Mandatory user initialization classes
   runManager->SetUserInitialization(new B5DetectorConstruction);
 
   auto physicsList = new FTFP_BERT;
   physicsList->RegisterPhysics(new G4StepLimiterPhysics());
+  // fast shower model in the EM calorimeter (/B5/fastsim/emcal): 
+  // its process is added to every e-, e+ and gamma step, even when the 
+  // model is off, so it is registered only on request
+  if ( fastSimulation ) {
+    auto fastSimulationPhysics = new G4FastSimulationPhysics();
+    fastSimulationPhysics->ActivateFastSimulation("e-");
+    fastSimulationPhysics->ActivateFastSimulation("e+");
+    fastSimulationPhysics->ActivateFastSimulation("gamma");
+    physicsList->RegisterPhysics(fastSimulationPhysics);
+  }
+  B5FastShowerSetup::SetPhysicsRegistered(fastSimulation);
   runManager->SetUserInitialization(physicsList);
 
   // User action initialization
-  runManager->SetUserInitialization(new B5ActionInitialization());
+  runManager->SetUserInitialization(new B5ActionInitialization(perWorkerFiles));
 
   // Visualization manager construction
-  auto visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // G4VisManager* visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
+  G4VisManager* visManager = nullptr;
+  if ( useVis ) {
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // G4VisManager* visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+  }
 
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
 
-  if ( !ui ) {
+  // Output file name (the analysis manager is created with the run action)
+  if ( output.size() ) {
+    UImanager->ApplyCommand("/analysis/setFileName " + output);
+  }
+
+  // Report the time spent since the start of the job
+  auto reportStartup = [startTime]() {
+    std::chrono::duration<double> startup 
+      = std::chrono::steady_clock::now() - startTime;
+    G4cout << "Startup time: " << startup.count() << " s" << G4endl;
+  };
+
+  if ( batchMode ) {
     // execute an argument macro file if exist
-    G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
-    // ui = new G4UIExecutive(argc, argv);
-    // UImanager->ApplyCommand("/control/execute init_vis.mac");
-    //     UImanager->ApplyCommand("/control/execute gui.mac");
-    // ui->SessionStart();
-    // delete ui;
+    if ( macro.size() ) {
+      if ( nofEvents < 0 ) reportStartup();
+      G4String command = "/control/execute ";
+      UImanager->ApplyCommand(command+macro);
+    }
+    if ( nofEvents >= 0 ) {
+      // initialize the kernel if the macro did not
+      auto state = G4StateManager::GetStateManager()->GetCurrentState();
+      if ( state == G4State_PreInit ) runManager->Initialize();
+      reportStartup();
 
+      runManager->BeamOn(nofEvents);
+    }
   }
   else {
-    UImanager->ApplyCommand("/control/execute init_vis.mac");
-    if (ui->IsGUI()) {
+    reportStartup();
+
+    if ( useVis ) {
+      UImanager->ApplyCommand("/control/execute init_vis.mac");
+    }
+    else {
+      UImanager->ApplyCommand("/control/execute init.mac");
+    }
+    if (useVis && ui->IsGUI()) {
          UImanager->ApplyCommand("/control/execute gui.mac");
     }     
     // start interactive session
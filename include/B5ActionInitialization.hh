@@ -31,18 +31,35 @@
 #define B5ActionInitialization_h 1
 
 #include "G4VUserActionInitialization.hh"
+#include "globals.hh"
+
+class B5LogMessenger;
+class B5StackingMessenger;
+class B5SweepManager;
+class B5EventAction;
 
 /// Action initialization class.
+///
+/// With perWorkerFiles the run actions write one analysis file per 
+/// worker instead of merging the ntuple on master.
 
 class B5ActionInitialization : public G4VUserActionInitialization
 {
   public:
-    B5ActionInitialization();
+    B5ActionInitialization(G4bool perWorkerFiles = false);
     virtual ~B5ActionInitialization();
 
     virtual void BuildForMaster() const;
     virtual void Build() const;
 
+  private:
+    B5LogMessenger* fLogMessenger;
+    B5StackingMessenger* fStackingMessenger;
+    B5SweepManager* fSweepManager;
+    G4bool fPerWorkerFiles;
+    // used only to book the ntuple columns on master, 
+    // not registered with (and so not deleted by) the run manager
+    mutable B5EventAction* fMasterEventAction;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
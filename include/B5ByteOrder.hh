@@ -0,0 +1,116 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5ByteOrder.hh
+/// \brief Little-endian encoding helpers for the B5 binary files
+
+#ifndef B5ByteOrder_h
+#define B5ByteOrder_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <cstring>
+
+// Store values in little-endian byte order, independently of the host
+
+inline void B5PutUInt32(unsigned char* out, std::uint32_t value)
+{
+  out[0] = static_cast<unsigned char>(value);
+  out[1] = static_cast<unsigned char>(value >> 8);
+  out[2] = static_cast<unsigned char>(value >> 16);
+  out[3] = static_cast<unsigned char>(value >> 24);
+}
+
+inline void B5PutUInt64(unsigned char* out, std::uint64_t value)
+{
+  B5PutUInt32(out, static_cast<std::uint32_t>(value));
+  B5PutUInt32(out + 4, static_cast<std::uint32_t>(value >> 32));
+}
+
+inline void B5PutInt32(unsigned char* out, G4int value)
+{
+  B5PutUInt32(out, static_cast<std::uint32_t>(value));
+}
+
+inline void B5PutFloat(unsigned char* out, G4double value)
+{
+  auto fvalue = static_cast<float>(value);
+  std::uint32_t bits;
+  std::memcpy(&bits, &fvalue, sizeof(bits));
+  B5PutUInt32(out, bits);
+}
+
+// Read values stored in little-endian byte order
+
+inline std::uint32_t B5GetUInt32(const unsigned char* in)
+{
+  return   static_cast<std::uint32_t>(in[0]) 
+         | static_cast<std::uint32_t>(in[1]) << 8
+         | static_cast<std::uint32_t>(in[2]) << 16
+         | static_cast<std::uint32_t>(in[3]) << 24;
+}
+
+inline std::uint64_t B5GetUInt64(const unsigned char* in)
+{
+  return   static_cast<std::uint64_t>(B5GetUInt32(in))
+         | static_cast<std::uint64_t>(B5GetUInt32(in + 4)) << 32;
+}
+
+inline G4int B5GetInt32(const unsigned char* in)
+{
+  return static_cast<std::int32_t>(B5GetUInt32(in));
+}
+
+inline float B5GetFloat(const unsigned char* in)
+{
+  auto bits = B5GetUInt32(in);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline G4double B5GetDouble(const unsigned char* in)
+{
+  auto bits = B5GetUInt64(in);
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Whether the host stores values in little-endian byte order, 
+// so that little-endian data can be used in place
+inline G4bool B5IsLittleEndianHost()
+{
+  const std::uint32_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
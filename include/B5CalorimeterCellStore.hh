@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5CalorimeterCellStore.hh
+/// \brief Definition of the B5CalorimeterCellStore class
+
+#ifndef B5CalorimeterCellStore_h
+#define B5CalorimeterCellStore_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include "G4RotationMatrix.hh"
+#include "G4LogicalVolume.hh"
+
+#include <array>
+#include <vector>
+
+/// Calorimeter cell store
+///
+/// A fixed-size array of calorimeter cells owned by a sensitive detector
+/// (i.e. one store per thread) which persists across events.
+/// The cells touched in the current event are recorded in a dirty list,
+/// so that resetting the store and exporting its content to a hits
+/// collection cost in proportion to the number of touched cells only.
+
+template <G4int N>
+class B5CalorimeterCellStore
+{
+  public:
+    struct Cell {
+      G4double fEdep = 0.;
+      G4ThreeVector fPos;
+      G4RotationMatrix fRot;
+      G4LogicalVolume* fPLogV = nullptr;
+      G4bool fTouched = false;
+    };
+
+    B5CalorimeterCellStore() : fCells(), fDirtyCells() { fDirtyCells.reserve(N); }
+
+    // reset the cells touched in the previous event
+    void Reset() {
+      for (auto id : fDirtyCells) fCells[id] = Cell();
+      fDirtyCells.clear();
+    }
+
+    // return the cell and record it as dirty on its first touch;
+    // isFirst tells the caller to fill the cell volume information
+    Cell& Touch(G4int id, G4bool& isFirst) {
+      auto& cell = fCells[id];
+      isFirst = ! cell.fTouched;
+      if (isFirst) {
+        cell.fTouched = true;
+        fDirtyCells.push_back(id);
+      }
+      return cell;
+    }
+
+    const Cell& GetCell(G4int id) const { return fCells[id]; }
+    const std::vector<G4int>& GetDirtyCells() const { return fDirtyCells; }
+
+    static constexpr G4int GetNofCells() { return N; }
+
+  private:
+    std::array<Cell, N> fCells;
+    std::vector<G4int> fDirtyCells;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -34,6 +34,8 @@
 
 constexpr G4int kNofHodoscopes1 = 15;
 constexpr G4int kNofHodoscopes2 = 25;
+constexpr G4int kNofHodoscopesMax
+  = kNofHodoscopes1 > kNofHodoscopes2 ? kNofHodoscopes1 : kNofHodoscopes2;
 // constexpr G4int kNofChambers = 6;
 constexpr G4int kNofChambers = 20;
 constexpr G4int kNofEmColumns = 20;
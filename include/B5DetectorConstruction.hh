@@ -38,6 +38,9 @@
 #include <vector>
 
 class B5MagneticField;
+class B5FieldSetup;
+class B5FastShowerSetup;
+class B5RegionCutMessenger;
 
 class G4VPhysicalVolume;
 class G4Material;
@@ -57,7 +60,14 @@ class B5DetectorConstruction : public G4VUserDetectorConstruction
     virtual void ConstructSDandField();
 
     void SetArmAngle(G4double val);
-    G4double GetArmAngle() { return fArmAngle; }
+    G4double GetArmAngle() const { return fArmAngle; }
+
+    void SetTrackingOnly(G4bool val);
+    G4bool IsTrackingOnly() const { return fTrackingOnly; }
+    G4VPhysicalVolume* GetSecondArmPhysical() const { return fSecondArmPhys; }
+    // the field of this thread
+    B5MagneticField* GetMagneticField() const { return fMagneticField; }
+    void ActivateSensitiveDetectors() const;
     
     void ConstructMaterials();
     
@@ -65,9 +75,11 @@ class B5DetectorConstruction : public G4VUserDetectorConstruction
     void DefineCommands();
 
     G4GenericMessenger* fMessenger;
+    B5RegionCutMessenger* fRegionCutMessenger;
     
     static G4ThreadLocal B5MagneticField* fMagneticField;
-    static G4ThreadLocal G4FieldManager* fFieldMgr;
+    static G4ThreadLocal B5FieldSetup* fFieldSetup;
+    static G4ThreadLocal B5FastShowerSetup* fFastShowerSetup;
     
     G4LogicalVolume* fHodoscope1Logical;
     G4LogicalVolume* fHodoscope2Logical;
@@ -83,6 +95,7 @@ class B5DetectorConstruction : public G4VUserDetectorConstruction
     G4double fArmAngle;
     G4RotationMatrix* fArmRotation;
     G4VPhysicalVolume* fSecondArmPhys;
+    G4bool fTrackingOnly;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -47,6 +47,7 @@ class G4AttValue;
 /// - the layer ID
 /// - the particle time
 /// - the particle local and global positions
+/// - the index of the primary track the particle descends from
 
 class B5DriftChamberHit : public G4VHit
 {
@@ -84,6 +85,9 @@ class B5DriftChamberHit : public G4VHit
 
     void SetInitAngle(G4double a) { fInitAngle = a; }
     G4double GetInitAngle() const { return fInitAngle; }
+
+    void SetTrackIndex(G4int i) { fTrackIndex = i; }
+    G4int GetTrackIndex() const { return fTrackIndex; }
     
   private:
     G4int fLayerID;
@@ -92,6 +96,7 @@ class B5DriftChamberHit : public G4VHit
     G4ThreeVector fWorldPos;
     G4double fMomentum;
     G4double fInitAngle;
+    G4int fTrackIndex;
 };
 
 using B5DriftChamberHitsCollection = G4THitsCollection<B5DriftChamberHit>;
@@ -37,30 +37,50 @@
 #include <vector>
 
 class G4Step;
+class B5PerfCounters;
 class G4HCofThisEvent;
 class G4TouchableHistory;
 
 /// Drift chamber sensitive detector
+///
+/// The role of the chamber is fixed at construction:
+/// - tracking planes (chamber1) record the hits used for tracking
+/// - the reference plane (chamberF) also records the initial angle
+///   of the track in the x-z plane
+/// Each role has its own step processing, so that the tracking path
+/// does only the work it needs.
+///
+/// At the end of event the hit positions are passed as contiguous arrays
+/// to the per-thread B5HoughAccumulator, which bins the hit pairs.
 
 class B5DriftChamberSD : public G4VSensitiveDetector
 {
   public:
-    B5DriftChamberSD(G4String name);
+    enum Role { kTrackingPlane, kReferencePlane };
+
+    B5DriftChamberSD(G4String name, Role role = kTrackingPlane);
     virtual ~B5DriftChamberSD();
     
     virtual void Initialize(G4HCofThisEvent*HCE);
     virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* ROhist);
     virtual void EndOfEvent(G4HCofThisEvent*HCE);
+
+    Role GetRole() const { return fRole; }
     
   private:
+    B5DriftChamberHit* CreateHit(const G4Step* step) const;
+    G4bool ProcessTrackingHit(G4Step* step);
+    G4bool ProcessReferenceHit(G4Step* step);
+
+    Role fRole;
     B5DriftChamberHitsCollection* fHitsCollection;
     G4int fHCID;
     double momentum_h;
-    std::vector<G4ThreeVector> hits;
+    // hit coordinates of this event for the pair histograms
+    std::vector<G4double> fHitX;
+    std::vector<G4double> fHitZ;
+    B5PerfCounters* fPerfCounters;
     // std::array<std::vector<int>,300> id_array;
-    int HistA = -1;
-    int HistB = -1;
-    int HistAB = -1;
 
 };
 
@@ -31,16 +31,28 @@
 #define B5EmCalorimeterSD_h 1
 
 #include "G4VSensitiveDetector.hh"
+#include "G4VGFlashSensitiveDetector.hh"
 
 #include "B5EmCalorimeterHit.hh"
+#include "B5CalorimeterCellStore.hh"
+#include "B5Constants.hh"
 
 class G4Step;
+class B5PerfCounters;
 class G4HCofThisEvent;
 class G4TouchableHistory;
+class G4VTouchable;
+class G4GFlashSpot;
 
 /// EM calorimeter sensitive detector
+///
+/// Energy deposits are accumulated in a persistent cell store; at the end
+/// of event only the touched cells are exported to the hits collection.
+/// The deposits come from the tracked particles or from the energy spots
+/// of the fast shower model (see B5FastShowerSetup).
 
-class B5EmCalorimeterSD : public G4VSensitiveDetector
+class B5EmCalorimeterSD : public G4VSensitiveDetector, 
+                          public G4VGFlashSensitiveDetector
 {   
   public:
     B5EmCalorimeterSD(G4String name);
@@ -48,10 +60,16 @@ class B5EmCalorimeterSD : public G4VSensitiveDetector
     
     virtual void Initialize(G4HCofThisEvent*HCE);
     virtual G4bool ProcessHits(G4Step*aStep,G4TouchableHistory*ROhist);
+    virtual G4bool ProcessHits(G4GFlashSpot*aSpot,G4TouchableHistory*ROhist);
+    virtual void EndOfEvent(G4HCofThisEvent*HCE);
     
   private:
+    void AddEdep(G4double edep, const G4VTouchable* touchable, G4int copyNo);
+
     B5EmCalorimeterHitsCollection* fHitsCollection;
     G4int fHCID;
+    B5CalorimeterCellStore<kNofEmCells> fCellStore;
+    B5PerfCounters* fPerfCounters;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
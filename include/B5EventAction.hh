@@ -37,6 +37,10 @@
 #include <vector>
 #include <array>
 
+class B5TraceRecorder;
+class B5PerfCounters;
+class B5MemoryReport;
+
 // named constants
 const G4int kEm = 0;
 const G4int kHad = 1;
@@ -57,6 +61,15 @@ public:
 
     std::vector<G4double>& GetEmCalEdep() { return fCalEdep[kEm]; }
     std::vector<G4double>& GetHadCalEdep() { return fCalEdep[kHad]; }
+    std::vector<G4int>& GetTrackIndex() { return fTrackIndex; }
+    std::vector<G4double>& GetTrackInitAngle() { return fTrackInitAngle; }
+
+    void SetHitsNtupleID(G4int id) { fHitsNtupleID = id; }
+    void SetTrackingOnly(G4bool val) { fTrackingOnly = val; }
+    void SetConfigID(G4int id) { fConfigID = id; }
+
+    // bytes reserved by the vectors of this class
+    std::size_t GetVectorBytes() const;
 
     std::vector<double> pos_x_vector;
     std::vector<double> pos_y_vector;
@@ -71,6 +84,22 @@ private:
     std::array<std::array<G4int, kDim>, kDim> fDriftHistoID;
     // energy deposit in calorimeters cells
     std::array<std::vector<G4double>, kDim> fCalEdep;
+    // cells filled in fCalEdep in the last event
+    std::array<std::vector<G4int>, kDim> fCalCellID;
+    // primary track index of the chamber 1 hits (parallel to pos_*_vector)
+    std::vector<G4int> fTrackIndex;
+    // angle at the reference chamber per primary track
+    std::vector<G4double> fTrackInitAngle;
+    std::vector<G4bool> fTrackHasAngle;
+    // flat hits ntuple Id
+    G4int fHitsNtupleID;
+    // calorimeters not read out (/B5/detector/trackingOnly)
+    G4bool fTrackingOnly;
+    // sweep configuration ID written in the ConfigID columns
+    G4int fConfigID;
+    B5TraceRecorder* fTraceRecorder;
+    B5PerfCounters* fPerfCounters;
+    B5MemoryReport* fMemoryReport;
     int str_ctr;
     int str_ctr2;
 };
@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FastShowerSetup.hh
+/// \brief Definition of the B5FastShowerSetup class
+
+#ifndef B5FastShowerSetup_h
+#define B5FastShowerSetup_h 1
+
+#include "globals.hh"
+
+class G4Region;
+class G4Material;
+class G4GenericMessenger;
+class GFlashShowerModel;
+class GFlashHomoShowerParameterisation;
+class GFlashParticleBounds;
+class GFlashHitMaker;
+
+/// Fast shower setup
+///
+/// Attaches a GFlash shower model to the EM calorimeter region: e+, e- 
+/// (and their photons) entering the CsI are not tracked further, the 
+/// parameterised longitudinal and lateral shower profiles are deposited 
+/// as energy spots directly in the calorimeter cells 
+/// (see B5EmCalorimeterSD).
+///
+/// The model is switched with /B5/fastsim/emcal on|off (off by default).
+/// It needs the fast simulation process, which is registered only when 
+/// the job is started with --fastsim (see exampleB5.cc).
+/// There is one instance per thread.
+
+class B5FastShowerSetup
+{
+  public:
+    B5FastShowerSetup(G4Region* region, G4Material* material);
+    ~B5FastShowerSetup();
+
+    void SetEmCal(const G4String& val);
+    G4bool IsEmCalOn() const { return fEmCalOn; }
+
+    // whether G4FastSimulationPhysics is registered, set before the run 
+    // initialization
+    static void SetPhysicsRegistered(G4bool val) { fgPhysicsRegistered = val; }
+
+  private:
+    void DefineCommands();
+
+    static G4bool fgPhysicsRegistered;
+
+    G4GenericMessenger* fMessenger;
+    GFlashShowerModel* fShowerModel;
+    GFlashHomoShowerParameterisation* fParameterisation;
+    GFlashParticleBounds* fParticleBounds;
+    GFlashHitMaker* fHitMaker;
+    G4bool fEmCalOn;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FieldMap.hh
+/// \brief Definition of the B5FieldMap class
+
+#ifndef B5FieldMap_h
+#define B5FieldMap_h 1
+
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+/// Magnetic field map on a regular 3D grid
+///
+/// The map is read from a binary file (little-endian):
+/// - header of 80 bytes: "B5FM", uint32 version (1), 
+///   int32 nx, ny, nz, 4 bytes padding,
+///   float64 xmin, ymin, zmin, dx, dy, dz (mm, global coordinates),
+///   8 bytes padding
+/// - nx*ny*nz nodes of float32 (Bx, By, Bz) in tesla, x running fastest
+///
+/// On POSIX systems the file is memory-mapped, otherwise it is read into
+/// memory. On big-endian hosts the nodes are decoded into memory. 
+/// A map is immutable once loaded and is shared by all threads, 
+/// see Load().
+///
+/// The field is interpolated trilinearly. The caller passes a Cache 
+/// (one per thread) holding the eight corners of the last cell, so that 
+/// successive lookups in the same cell skip the index computation and 
+/// do not touch the map memory. Outside the grid the field is zero.
+
+class B5FieldMap
+{
+  public:
+    struct Cache {
+      G4bool fValid = false;
+      G4double fX0 = 0.;
+      G4double fY0 = 0.;
+      G4double fZ0 = 0.;
+      // field at the 8 corners, corner index = ix + 2*iy + 4*iz
+      float fCorner[8][3];
+    };
+
+    ~B5FieldMap();
+
+    // load the map, or return the one already loaded from this file
+    static std::shared_ptr<const B5FieldMap> Load(const G4String& fileName);
+
+    void GetFieldValue(const G4double point[3], G4double* bField, 
+                       Cache& cache) const;
+
+    const G4String& GetFileName() const { return fFileName; }
+
+    static constexpr std::size_t kHeaderSize = 80;
+
+  private:
+    explicit B5FieldMap(const G4String& fileName);
+
+    G4bool LocateCell(const G4double point[3], Cache& cache) const;
+    const float* GetNode(G4int ix, G4int iy, G4int iz) const {
+      return fNodes + 3*(ix + fNx*(iy + fNy*iz)); 
+    }
+
+    G4String fFileName;
+    G4int fNx, fNy, fNz;
+    G4double fMin[3];
+    G4double fStep[3];
+    G4double fInvStep[3];
+    const float* fNodes;
+    // the file mapping, or the buffer if the file is read 
+    // or the nodes are decoded
+    void* fMapping;
+    std::size_t fMappingSize;
+    std::vector<float> fBuffer;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FieldSetup.hh
+/// \brief Definition of the B5FieldSetup class
+
+#ifndef B5FieldSetup_h
+#define B5FieldSetup_h 1
+
+#include "globals.hh"
+
+class B5MagneticField;
+
+class G4FieldManager;
+class G4ChordFinder;
+class G4Mag_UsualEqRhs;
+class G4MagIntegratorStepper;
+class G4GenericMessenger;
+
+/// Field setup
+///
+/// Owns the field manager of the magnetic volume and builds its chord
+/// finder with the stepper selected with /B5/field/stepper:
+/// - auto: the exact helix stepper for the uniform field,
+///   the Dormand-Prince 7(4)5 Runge-Kutta stepper for a field map
+/// - exactHelix, classicalRK4, cashKarpRKF45, dormandPrince745
+/// The exact helix stepper is valid only in a uniform field, so with a
+/// field map the Dormand-Prince stepper is used instead.
+///
+/// The chord finder accuracy parameters can be tuned with 
+/// /B5/field/deltaChord, deltaOneStep, minEpsilon, maxEpsilon.
+///
+/// There is one instance per thread. Update() is called at the beginning
+/// of each run to rebuild the chord finder if the field mode changed.
+
+class B5FieldSetup
+{
+  public:
+    B5FieldSetup(B5MagneticField* field);
+    ~B5FieldSetup();
+
+    static B5FieldSetup* GetInstance() { return fgInstance; }
+
+    G4FieldManager* GetFieldManager() const { return fFieldManager; }
+
+    void Update();
+
+    void SetStepperType(const G4String& val);
+    void SetDeltaChord(G4double val);
+    void SetDeltaOneStep(G4double val);
+    void SetMinEpsilon(G4double val);
+    void SetMaxEpsilon(G4double val);
+
+  private:
+    void BuildChordFinder();
+    void ApplyAccuracy();
+    G4String SelectStepper() const;
+    void DefineCommands();
+
+    static G4ThreadLocal B5FieldSetup* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    B5MagneticField* fField;
+    G4FieldManager* fFieldManager;
+    G4Mag_UsualEqRhs* fEquation;
+    G4MagIntegratorStepper* fStepper;
+    G4ChordFinder* fChordFinder;
+
+    G4String fStepperType;
+    G4String fBuiltStepper;
+    G4double fMinStep;
+    G4double fDeltaChord;
+    G4double fDeltaOneStep;
+    G4double fMinEpsilon;
+    G4double fMaxEpsilon;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
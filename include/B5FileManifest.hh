@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FileManifest.hh
+/// \brief Definition of the B5FileManifest class
+
+#ifndef B5FileManifest_h
+#define B5FileManifest_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/// Manifest of the per-worker analysis files
+///
+/// When the ntuples are not merged on master, each worker writes its own
+/// file <name>_t<thread>.root with the B5 ntuple, while the histograms
+/// are merged in the master file <name>.root.
+/// The workers register their file at the end of run and the master 
+/// then writes:
+/// - <name>.manifest: the list of files, to be used as a chain of the 
+///   B5 ntuple when merging is not needed
+/// - <name>_merge.sh: a script merging all files in parallel with 
+///   hadd -j into the final <name>.root
+///
+/// Geant4 writes ROOT files with zlib only; when another compression
+/// algorithm is selected (/B5/output/compression) the merge script is
+/// also written for a single file and recompresses the output with the
+/// corresponding ROOT compression settings (algorithm*100 + level).
+
+class B5FileManifest
+{
+  public:
+    static void Register(const G4String& fileName);
+    static void Write(const G4String& masterFileName, G4int runID);
+
+    static G4String GetWorkerFileName(const G4String& fileName, 
+                                      G4int threadID);
+
+    // ROOT compression settings of the merged file, -1 to keep them
+    static void SetCompressionSettings(G4int val) { fgCompression = val; }
+    static G4int GetCompressionSettings() { return fgCompression; }
+
+  private:
+    static G4String GetBaseName(const G4String& fileName);
+
+    static std::mutex fgMutex;
+    static std::vector<G4String> fgFiles;
+    static std::atomic<G4int> fgCompression;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -33,12 +33,18 @@
 #include "G4VSensitiveDetector.hh"
 
 #include "B5HadCalorimeterHit.hh"
+#include "B5CalorimeterCellStore.hh"
+#include "B5Constants.hh"
 
 class G4Step;
+class B5PerfCounters;
 class G4HCofThisEvent;
 class G4TouchableHistory;
 
 /// Hadron calorimeter sensitive detector
+///
+/// Energy deposits are accumulated in a persistent cell store; at the end
+/// of event only the touched cells are exported to the hits collection.
 
 class B5HadCalorimeterSD : public G4VSensitiveDetector
 {    
@@ -48,10 +54,13 @@ class B5HadCalorimeterSD : public G4VSensitiveDetector
     
     virtual void Initialize(G4HCofThisEvent*HCE);
     virtual G4bool ProcessHits(G4Step*aStep,G4TouchableHistory*ROhist);
+    virtual void EndOfEvent(G4HCofThisEvent*HCE);
     
   private:
     B5HadCalorimeterHitsCollection* fHitsCollection;
     G4int fHCID;
+    B5CalorimeterCellStore<kNofHadCells> fCellStore;
+    B5PerfCounters* fPerfCounters;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
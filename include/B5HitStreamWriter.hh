@@ -0,0 +1,122 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5HitStreamWriter.hh
+/// \brief Definition of the B5HitStreamWriter class
+
+#ifndef B5HitStreamWriter_h
+#define B5HitStreamWriter_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Binary hit stream writer
+///
+/// Each worker thread writes the drift chamber hits of its events into its
+/// own shard file, <prefix>_r<run>_t<thread>.bin. Records are packed into
+/// a large preallocated buffer which is handed over to a background thread
+/// for writing when full (double buffering), so the event loop does not
+/// wait on the disk. At the end of run the master writes the manifest
+/// <prefix>_r<run>.manifest listing all shards and their record counts.
+/// A failed write (e.g. a full disk) is reported with a warning and the 
+/// manifest then lists the complete records actually written.
+///
+/// Shard layout (all values little-endian):
+/// - header: "B5HS", uint32 version (1), uint32 record size (28)
+/// - records: int32 event ID, int32 layer ID, float32 x, y, z (mm), 
+///   float32 t (ns), float32 p (GeV)
+///
+/// The stream is enabled with /B5/output/hitStream <prefix>.
+
+class B5HitStreamWriter
+{
+  public:
+    ~B5HitStreamWriter();
+
+    static B5HitStreamWriter* Instance();
+
+    void Open(G4int runID);
+    void Close();
+    G4bool IsOpen() const { return fFile != nullptr; }
+
+    void Write(G4int eventID, G4int layerID, const G4ThreeVector& pos,
+               G4double time, G4double momentum);
+
+    static void WriteManifest(G4int runID);
+
+    void SetPrefix(const G4String& val);
+    const G4String& GetPrefix() const { return fPrefix; }
+    G4bool IsEnabled() const { return ! fPrefix.empty(); }
+
+    static constexpr std::size_t kRecordSize = 28;
+
+  private:
+    B5HitStreamWriter();
+
+    void DefineCommands();
+    void Submit();
+    void FlushLoop();
+
+    static G4ThreadLocal B5HitStreamWriter* fgInstance;
+    // shards written in this process (file name, number of records)
+    static std::mutex fgShardMutex;
+    static std::vector<std::pair<G4String, G4long>> fgShards;
+
+    G4GenericMessenger* fMessenger;
+    G4String fPrefix;
+    G4int fBufferSizeMB;
+
+    std::FILE* fFile;
+    G4String fFileName;
+    G4long fNofRecords;
+    // set by a failed write, after which the shard is not written anymore
+    G4bool fWriteError;
+
+    // buffer being filled and buffer being written
+    std::vector<unsigned char> fBuffer;
+    std::size_t fBufferUsed;
+    std::vector<unsigned char> fFlushBuffer;
+    std::size_t fFlushSize;
+
+    std::thread fFlushThread;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    G4bool fFlushPending;
+    G4bool fStop;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
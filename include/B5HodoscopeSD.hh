@@ -32,12 +32,22 @@
 
 #include "G4VSensitiveDetector.hh"
 #include "B5HodoscopeHit.hh"
+#include "B5Constants.hh"
+
+#include <array>
 
 class G4Step;
+class B5PerfCounters;
 class G4HCofThisEvent;
 class G4TouchableHistory;
 
 /// Hodoscope sensitive detector
+///
+/// The hit of each strip is found via a per-event strip index
+/// (copy number -> position in the hits collection), so the cost of
+/// a step does not depend on the number of strips already hit.
+/// The number of hit lookups is counted per event and per run; the counts
+/// are printed at end of event with /B5/log/level debug.
 
 class B5HodoscopeSD : public G4VSensitiveDetector
 {
@@ -47,10 +57,19 @@ class B5HodoscopeSD : public G4VSensitiveDetector
     
     virtual void Initialize(G4HCofThisEvent*HCE);
     virtual G4bool ProcessHits(G4Step*aStep,G4TouchableHistory*ROhist);
+    virtual void EndOfEvent(G4HCofThisEvent*HCE);
+
+    G4long GetNofLookups() const { return fNofLookups; }
+    G4long GetNofLookupsTotal() const { return fNofLookupsTotal; }
     
   private:
     B5HodoscopeHitsCollection* fHitsCollection;
     G4int fHCID;
+    // index of the hit of each strip in fHitsCollection, -1 if none
+    std::array<G4int, kNofHodoscopesMax> fHitIndex;
+    G4long fNofLookups;
+    G4long fNofLookupsTotal;
+    B5PerfCounters* fPerfCounters;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,115 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5HoughAccumulator.hh
+/// \brief Definition of the B5HoughAccumulator class
+
+#ifndef B5HoughAccumulator_h
+#define B5HoughAccumulator_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <cstddef>
+
+class G4GenericMessenger;
+
+// binning of the pair histograms (HistA, HistB, HistAB)
+constexpr G4int kNofHoughABins = 300;
+constexpr G4double kHoughAMin = -1.8;
+constexpr G4double kHoughAMax = -1.4;
+constexpr G4int kNofHoughBBins = 300;
+constexpr G4double kHoughBMin = -9000.;
+constexpr G4double kHoughBMax = -7000.;
+
+/// Pairwise Hough accumulator
+///
+/// For every pair of drift chamber hits of an event it computes the angle
+/// and the intercept of the line through the two hits in the x-z plane,
+/// and bins them into flat arrays. The hits of a whole event are passed 
+/// as contiguous arrays so that the pair kernel can be vectorised.
+/// Like the tools histograms, each bin keeps its entries and the sums of
+/// x and x^2 (and y, y^2 in 2D), so the entries, mean and RMS are exact.
+///
+/// There is one instance per thread, created by the run action after 
+/// the histograms are booked, so that their IDs are resolved once and 
+/// its command is also defined on master before the run initialization.
+/// The bins are merged into the HistA, HistB and HistAB histograms only
+/// at the end of run, before they are written.
+/// The accumulation can be switched off with /B5/chamber/pairHistograms.
+
+class B5HoughAccumulator
+{
+  public:
+    ~B5HoughAccumulator();
+
+    static B5HoughAccumulator* Instance();
+
+    void Reset();
+    void AddEvent(const G4double* x, const G4double* z, std::size_t nofHits);
+    void MergeIntoHistograms() const;
+
+    void SetEnabled(G4bool val) { fEnabled = val; }
+    G4bool IsEnabled() const { return fEnabled; }
+
+  private:
+    B5HoughAccumulator();
+
+    // bins including the underflow (0) and overflow (n+1) bins, 
+    // filled with unit weights (the sum of weights is the entries)
+    struct Bins {
+      Bins(std::size_t size, G4bool hasY);
+      void Reset();
+      std::vector<G4double> fEntries;
+      std::vector<G4double> fSumX;
+      std::vector<G4double> fSumX2;
+      // 2D only
+      std::vector<G4double> fSumY;
+      std::vector<G4double> fSumY2;
+    };
+
+    void DefineCommands();
+
+    static G4ThreadLocal B5HoughAccumulator* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4int fHistAId;
+    G4int fHistBId;
+    G4int fHistABId;
+    Bins fBinsA;
+    Bins fBinsB;
+    Bins fBinsAB;
+    // scratch arrays for the pairs of one hit
+    std::vector<G4double> fAngle;
+    std::vector<G4double> fIntercept;
+    std::vector<G4int> fBinA;
+    std::vector<G4int> fBinB;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
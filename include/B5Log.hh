@@ -0,0 +1,128 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5Log.hh
+/// \brief Definition of the B5Log class and the B5_LOG macros
+
+#ifndef B5Log_h
+#define B5Log_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+
+class G4GenericMessenger;
+
+// Messages below this level are removed at compile time.
+// By default everything is compiled in, except the debug and trace
+// messages in release (NDEBUG) builds.
+#ifndef B5_LOG_MIN_LEVEL
+#  ifdef NDEBUG
+#    define B5_LOG_MIN_LEVEL 2
+#  else
+#    define B5_LOG_MIN_LEVEL 0
+#  endif
+#endif
+
+/// Logging facility for the simulation hot paths
+///
+/// Messages have a level and are printed via G4cout (G4cerr for warnings
+/// and errors), so in MT mode they get the worker thread prefix and
+/// are buffered per thread like any other Geant4 output.
+/// - the messages below B5_LOG_MIN_LEVEL are compiled out
+/// - the messages below the runtime level (/B5/log/level) are skipped
+///   at the cost of one relaxed atomic load
+/// - each call site prints at most /B5/log/rateLimit messages per thread
+
+class B5Log
+{
+  public:
+    enum Level { kTrace = 0, kDebug, kInfo, kWarning, kError, kOff };
+
+    static constexpr G4bool IsCompiled(G4int level) { 
+      return level >= B5_LOG_MIN_LEVEL; 
+    }
+    static G4bool IsEnabled(G4int level) { 
+      return IsCompiled(level) 
+             && level >= fgLevel.load(std::memory_order_relaxed); 
+    }
+
+    static void SetLevel(G4int level) { fgLevel = level; }
+    static G4int GetLevel() { return fgLevel; }
+    static void SetRateLimit(G4int val) { fgRateLimit = val; }
+    static G4int GetRateLimit() { return fgRateLimit; }
+
+    // count a message of a call site, return false if it is over the limit
+    static G4bool Count(G4int& siteCounter);
+
+    static void Print(G4int level, const char* format, ...)
+#if defined(__GNUC__)
+      __attribute__((format(printf, 2, 3)))
+#endif
+      ;
+
+  private:
+    static std::atomic<G4int> fgLevel;
+    static std::atomic<G4int> fgRateLimit;
+};
+
+/// Messenger of the logging facility (/B5/log/ commands)
+///
+/// The log level is shared by all threads, so one instance created 
+/// on the master is enough.
+
+class B5LogMessenger
+{
+  public:
+    B5LogMessenger();
+    ~B5LogMessenger();
+
+    void SetLevel(const G4String& name);
+    void SetRateLimit(G4int val) { B5Log::SetRateLimit(val); }
+
+  private:
+    G4GenericMessenger* fMessenger;
+};
+
+// Print a printf-style message with the given level
+#define B5_LOG(level, ...)                                        \
+  do {                                                            \
+    if (B5Log::IsCompiled(level) && B5Log::IsEnabled(level)) {    \
+      static G4ThreadLocal G4int b5LogSiteCounter = 0;            \
+      if (B5Log::Count(b5LogSiteCounter)) {                       \
+        B5Log::Print(level, __VA_ARGS__);                         \
+      }                                                           \
+    }                                                             \
+  } while (0)
+
+#define B5_TRACE(...) B5_LOG(B5Log::kTrace, __VA_ARGS__)
+#define B5_DEBUG(...) B5_LOG(B5Log::kDebug, __VA_ARGS__)
+#define B5_INFO(...)  B5_LOG(B5Log::kInfo, __VA_ARGS__)
+#define B5_WARN(...)  B5_LOG(B5Log::kWarning, __VA_ARGS__)
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
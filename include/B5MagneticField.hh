@@ -32,10 +32,18 @@
 
 #include "globals.hh"
 #include "G4MagneticField.hh"
+#include "B5FieldMap.hh"
+
+#include <memory>
 
 class G4GenericMessenger;
 
 /// Magnetic field
+///
+/// By default the field is uniform along y (/B5/field/value).
+/// With /B5/field/map <file> the field is interpolated from a field map
+/// (see B5FieldMap); the field object is thread-local, so is the cache
+/// of the last map cell used.
 
 class B5MagneticField : public G4MagneticField
 {
@@ -47,12 +55,17 @@ class B5MagneticField : public G4MagneticField
     
     void SetField(G4double val) { fBy = val; }
     G4double GetField() const { return fBy; }
+
+    void SetFieldMap(const G4String& fileName);
+    G4bool IsMapped() const { return fFieldMap != nullptr; }
     
   private:
     void DefineCommands();
 
     G4GenericMessenger* fMessenger;
     G4double fBy;
+    std::shared_ptr<const B5FieldMap> fFieldMap;
+    mutable B5FieldMap::Cache fMapCache;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5MemoryReport.hh
+/// \brief Definition of the B5MemoryReport class
+
+#ifndef B5MemoryReport_h
+#define B5MemoryReport_h 1
+
+#include "globals.hh"
+
+#include <cstddef>
+
+class G4Event;
+class G4HCofThisEvent;
+class G4GenericMessenger;
+
+/// Memory report
+///
+/// Prints one line per thread with the process resident set size and its
+/// high-water mark (from /proc/self/status on Linux, the peak only from 
+/// getrusage elsewhere), the G4Allocator pool sizes of the four hit types
+/// of this thread and the number of histograms and their bins. The reports
+/// at the end of an event also give the size of each hits collection and 
+/// the bytes reserved by the event action vectors.
+///
+/// /B5/mem/report [nEvents] prints a report and switches on the reports 
+/// at the start and the end of each run and, if nEvents > 0, every 
+/// nEvents events of each thread; /B5/mem/report -1 switches them off.
+
+class B5MemoryReport
+{
+  public:
+    ~B5MemoryReport();
+
+    static B5MemoryReport* Instance();
+
+    void BeginOfRun(G4int runID);
+    void EndOfEvent(const G4Event* event, std::size_t eventActionBytes);
+    void EndOfRun(G4int runID);
+
+    void Report(const G4String& when, 
+                G4HCofThisEvent* hce = nullptr,
+                std::size_t eventActionBytes = 0) const;
+
+    // Resident set size and its high-water mark in bytes, 
+    // 0 if not available
+    static void GetProcessMemory(G4double& rss, G4double& peak);
+
+    void SetReport(G4int nEvents);
+    G4bool IsEnabled() const { return fEveryNEvents >= 0; }
+
+  private:
+    B5MemoryReport();
+
+    void DefineCommands();
+
+    static G4ThreadLocal B5MemoryReport* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    // -1 off, 0 at the start and end of run only
+    G4int fEveryNEvents;
+    G4int fNofEvents;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
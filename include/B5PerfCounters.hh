@@ -0,0 +1,152 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5PerfCounters.hh
+/// \brief Definition of the B5PerfCounters class
+
+#ifndef B5PerfCounters_h
+#define B5PerfCounters_h 1
+
+#include "globals.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+class G4GenericMessenger;
+
+/// Hardware performance counters (Linux only)
+///
+/// Each worker thread opens a perf_event_open group counting the cycles,
+/// instructions, cache misses and branch misses of this thread in user 
+/// space. The counters are read at the begin and the end of each event 
+/// and around the ProcessHits() of the sensitive detectors (see SDScope),
+/// and the per-event differences are written to the side file 
+/// <prefix>_r<run>_t<thread>.csv
+/// (event,cycles,instructions,cacheMisses,branchMisses,
+///  sdCycles,sdInstructions,sdCacheMisses,sdBranchMisses,running).
+/// The master prints the totals of all threads at the end of run.
+///
+/// When the PMU is shared (more events than counters, other perf users)
+/// the kernel multiplexes the group, which then counts only part of the 
+/// time. Each difference is scaled by the ratio of the time enabled to 
+/// the time running; the running column is the fraction of the event 
+/// during which the group was counting (1 without multiplexing, 0 if it 
+/// never ran and the values are unknown).
+///
+/// Each read is a system call, so the counters are enabled only with 
+/// /B5/profile/perfCounters <prefix>. Where the counters cannot be 
+/// opened (other systems, kernel.perf_event_paranoid, virtual machines
+/// without PMU) a warning is issued and the run continues without them.
+
+class B5PerfCounters
+{
+  public:
+    enum { kCycles, kInstructions, kCacheMisses, kBranchMisses, kNofCounters };
+    using Values = std::array<std::uint64_t, kNofCounters>;
+
+    /// Counts the enclosing ProcessHits() call in the SD counters; 
+    /// the sensitive detectors keep the pointer to the instance of their 
+    /// thread, so that nothing but IsOpen() is called when the counters
+    /// are off
+    class SDScope 
+    {
+      public:
+        explicit SDScope(B5PerfCounters* counters) : fCounters(counters) 
+          { if (fCounters->IsOpen()) fCounters->BeginSD(); }
+        ~SDScope() 
+          { if (fCounters->IsOpen()) fCounters->EndSD(); }
+      private:
+        B5PerfCounters* fCounters;
+    };
+
+    ~B5PerfCounters();
+
+    static B5PerfCounters* Instance();
+
+    void Open(G4int runID);
+    void Close();
+    G4bool IsOpen() const { return fGroupFd >= 0; }
+
+    void BeginEvent();
+    void EndEvent(G4int eventID);
+    void BeginSD();
+    void EndSD();
+
+    // Print and reset the totals of all threads
+    static void PrintTotals();
+
+    void SetPrefix(const G4String& val);
+    const G4String& GetPrefix() const { return fPrefix; }
+    G4bool IsEnabled() const { return ! fPrefix.empty(); }
+
+  private:
+    B5PerfCounters();
+
+    // counter values with the times the group was enabled and running
+    struct Sample {
+      Values fValues;
+      std::uint64_t fEnabled;
+      std::uint64_t fRunning;
+    };
+
+    void DefineCommands();
+    void Read(Sample& sample);
+    // scaled differences, returns the fraction of time running
+    static G4double Difference(const Sample& begin, const Sample& end,
+                               Values& values);
+
+    static G4ThreadLocal B5PerfCounters* fgInstance;
+    // totals of all threads in this run
+    static std::mutex fgMutex;
+    static Values fgEventTotal;
+    static Values fgSDTotal;
+    static G4long fgNofEvents;
+    static G4long fgNofMultiplexed;
+
+    G4GenericMessenger* fMessenger;
+    G4String fPrefix;
+
+    std::array<int, kNofCounters> fFds;
+    int fGroupFd;
+    std::FILE* fFile;
+
+    Sample fEventBegin;
+    Sample fSDBegin;
+    // this event
+    Values fSDEvent;
+    // this run
+    Values fEventTotal;
+    Values fSDTotal;
+    G4long fNofEvents;
+    // events counted only part of the time
+    G4long fNofMultiplexed;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -37,11 +37,15 @@ class G4ParticleGun;
 class G4GenericMessenger;
 class G4Event;
 class G4ParticleDefinition;
+class B5TraceRecorder;
 
 /// Primary generator
 ///
-/// A single particle is generated.
+/// A single particle is generated by default; with
+/// /B5/generator/tracksPerEvent N a bunch of N tracks is generated,
+/// each with its own randomised particle type, momentum and angle.
 /// User can select 
+/// - the number of tracks per event
 /// - the initial momentum and angle
 /// - the momentum and angle spreads
 /// - random selection of a particle type from proton, kaon+, pi+, muon+, e+ 
@@ -66,9 +70,13 @@ class B5PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 
     void SetRandomize(G4bool val) { fRandomizePrimary = val; }
     G4bool GetRandomize() const { return fRandomizePrimary; }
+
+    void SetTracksPerEvent(G4int val) { fTracksPerEvent = val; }
+    G4int GetTracksPerEvent() const { return fTracksPerEvent; }
     
   private:
     void DefineCommands();
+    void GenerateTrack(G4Event* event);
 
     G4ParticleGun* fParticleGun;
     G4GenericMessenger* fMessenger;
@@ -81,6 +89,8 @@ class B5PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     G4double fSigmaMomentum;
     G4double fSigmaAngle;
     G4bool fRandomizePrimary;
+    G4int fTracksPerEvent;
+    B5TraceRecorder* fTraceRecorder;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,68 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5RegionCutMessenger.hh
+/// \brief Definition of the B5RegionCutMessenger class
+
+#ifndef B5RegionCutMessenger_h
+#define B5RegionCutMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+
+/// Messenger of the region production cuts (/B5/region/ commands)
+///
+/// /B5/region/cut region value unit sets the production cut of all 
+/// particles in one of the regions defined in B5DetectorConstruction 
+/// (Tracker, Scintillator, EMCal, HadCal). A region gets its own 
+/// G4ProductionCuts on the first call, the other regions keep the 
+/// default cut. The region store is shared, so one instance created 
+/// on the master is enough.
+///
+/// G4GenericMessenger methods take at most two arguments, hence the 
+/// plain G4UImessenger.
+
+class B5RegionCutMessenger : public G4UImessenger
+{
+  public:
+    B5RegionCutMessenger();
+    virtual ~B5RegionCutMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+    void SetCut(const G4String& regionName, G4double cut);
+
+  private:
+    G4UIdirectory* fDirectory;
+    G4UIcommand* fCutCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
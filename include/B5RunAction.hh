@@ -33,23 +33,58 @@
 #include "G4UserRunAction.hh"
 #include "globals.hh"
 
+#include <chrono>
+
 class B5EventAction;
+class B5SteppingAction;
+class G4GenericMessenger;
 
 class G4Run;
 
 /// Run action class
+///
+/// The B5 ntuple has one row per event; the optional B5Hits ntuple 
+/// (/B5/output/hitsNtuple) has one row per chamber 1 hit with scalar 
+/// columns, for bulk reading without per-event vectors.
+///
+/// The output compression and basket sizing are set with 
+/// /B5/output/compression, basketSize and autoFlush.
+///
+/// By default the ntuple rows of all workers are merged on master;
+/// with perWorkerFiles each worker writes its own file and the master
+/// writes a manifest and a merge script (see B5FileManifest).
+///
+/// Each thread measures the wall time of its run; at the end of run the
+/// master prints the event rate of the job and per thread.
 
 class B5RunAction : public G4UserRunAction
 {
   public:
-    B5RunAction(B5EventAction* eventAction);
+    B5RunAction(B5EventAction* eventAction, 
+                B5SteppingAction* steppingAction = nullptr,
+                G4bool perWorkerFiles = false);
     virtual ~B5RunAction();
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
 
+    void SetHitsNtuple(G4bool active);
+    void SetCompression(G4String algorithm, G4int level);
+    void SetBasketSize(G4int size);
+    void SetAutoFlush(G4int entries);
+
   private:
+    void DefineCommands();
+    void PrintEventRates(G4int nofEvents, G4double seconds);
+
     B5EventAction* fEventAction;
+    B5SteppingAction* fSteppingAction;
+    G4bool fPerWorkerFiles;
+    G4GenericMessenger* fMessenger;
+    G4int fHitsNtupleID;
+    // configuration of the sweep point (/B5/output/configID)
+    G4int fConfigID;
+    std::chrono::steady_clock::time_point fStartTime;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
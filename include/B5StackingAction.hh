@@ -0,0 +1,145 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5StackingAction.hh
+/// \brief Definition of the B5StackingAction and B5StackingMessenger classes
+
+#ifndef B5StackingAction_h
+#define B5StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4ParticleDefinition;
+class G4Region;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+
+/// Stacking action
+///
+/// Secondaries are classified by an ordered list of rules (/B5/stack/), 
+/// each matching a particle type, the region where the track is created 
+/// and a maximum kinetic energy. The first matching rule kills the track, 
+/// postpones it to the waiting stack or keeps it; secondaries matching 
+/// no rule and primaries are kept. 
+///
+/// The rules are shared by all threads and are changed on master 
+/// between runs; each thread resolves its own copy when they change. 
+/// The number of tracks and their kinetic energy are counted per rule.
+/// The cost of the tracks kept or postponed by a rule, their steps and 
+/// thread CPU time, is attributed to the rule too: the rule is recorded 
+/// in the B5TrackInformation of the track and B5TrackingAction reports 
+/// the track cost with AddTrackCost(). The cost of the descendants of a 
+/// track goes to the rules which classify them.
+/// The counters are added to a run total at the end of run of each 
+/// thread and printed by the master.
+
+class B5StackingAction : public G4UserStackingAction
+{
+  public:
+    B5StackingAction();
+    virtual ~B5StackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+    virtual void PrepareNewEvent();
+
+    static B5StackingAction* Instance() { return fgInstance; }
+
+    // Add the steps and CPU time of a track classified by a rule
+    // (or B5TrackInformation::kOtherStackingRule)
+    void AddTrackCost(G4int rule, G4int nofSteps, G4double seconds);
+
+    // Rules, in the order of matching
+    static G4bool AddRule(G4ClassificationOfNewTrack classification,
+                          const G4String& particleName, 
+                          const G4String& regionName,
+                          G4double maxEnergy);
+    static void ClearRules();
+    static void ListRules();
+
+    // Add the counters of this thread to the run total
+    static void MergeCounters();
+    // Print and reset the run total
+    static void PrintCounters();
+
+  private:
+    struct Rule {
+      G4ClassificationOfNewTrack fClassification;
+      // nullptr matches all
+      const G4ParticleDefinition* fParticle;
+      const G4Region* fRegion;
+      // 0 matches all energies
+      G4double fMaxEnergy;
+      // counters
+      G4long fNofTracks;
+      G4double fEnergy;
+      G4long fNofSteps;
+      G4double fSeconds;
+    };
+
+    void UpdateRules();
+
+    static G4ThreadLocal B5StackingAction* fgInstance;
+
+    std::vector<Rule> fRules;
+    G4int fRulesVersion;
+    // secondaries matching no rule
+    G4long fNofOtherTracks;
+    G4double fOtherEnergy;
+    G4long fNofOtherSteps;
+    G4double fOtherSeconds;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Messenger of the stacking rules (/B5/stack/ commands)
+///
+/// The rules are shared by all threads, so one instance created 
+/// on the master is enough. The rule command has five parameters, 
+/// more than G4GenericMessenger methods take.
+
+class B5StackingMessenger : public G4UImessenger
+{
+  public:
+    B5StackingMessenger();
+    virtual ~B5StackingMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    G4UIdirectory* fDirectory;
+    G4UIcommand* fAddRuleCmd;
+    G4UIcmdWithoutParameter* fClearRulesCmd;
+    G4UIcmdWithoutParameter* fListRulesCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,109 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5StepProfiler.hh
+/// \brief Definition of the B5StepProfiler class
+
+#ifndef B5StepProfiler_h
+#define B5StepProfiler_h 1
+
+#include "B5ThreadClock.hh"
+#include "globals.hh"
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+class G4Step;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4GenericMessenger;
+
+/// Step profiler
+///
+/// Counts the steps and their time per logical volume (of the pre-step 
+/// point) and per particle type in thread-local tables. The time of a step
+/// is the CPU time of the thread since its previous step, or since the 
+/// start of its track for the first step, so it includes the tracking
+/// and the sensitive detectors but not the event overhead. The thread CPU
+/// clock is not charged with preemption and I/O stalls; where it is not
+/// available the wall clock is used (see B5ThreadClock.hh).
+///
+/// At the end of run each thread adds its tables to the run total, which
+/// the master prints sorted by time and writes to <prefix>_r<run>.csv
+/// (type,name,steps,cpuSeconds,stepFraction,timeFraction, 
+/// wallSeconds instead of cpuSeconds with the wall clock).
+///
+/// The profiler is enabled with /B5/profile/steps <prefix> and called
+/// from B5SteppingAction and B5TrackingAction.
+
+class B5StepProfiler
+{
+  public:
+    ~B5StepProfiler();
+
+    static B5StepProfiler* Instance();
+
+    void StartTrack() { fLastTime = B5ThreadClockSeconds(); }
+    void Step(const G4Step* step);
+
+    // Add the tables of this thread to the run total
+    void Merge();
+    // Print and write the run total, then reset it
+    static void WriteReport(G4int runID);
+
+    void SetPrefix(const G4String& val);
+    const G4String& GetPrefix() const { return fPrefix; }
+    G4bool IsEnabled() const { return fEnabled; }
+
+  private:
+    B5StepProfiler();
+
+    void DefineCommands();
+
+    struct Entry {
+      G4long fNofSteps = 0;
+      G4double fSeconds = 0.;
+    };
+
+    static G4ThreadLocal B5StepProfiler* fgInstance;
+    // run totals by name
+    static std::mutex fgMutex;
+    static std::map<G4String, Entry> fgVolumes;
+    static std::map<G4String, Entry> fgParticles;
+
+    G4GenericMessenger* fMessenger;
+    G4String fPrefix;
+    G4bool fEnabled;
+
+    G4double fLastTime;
+    std::unordered_map<const G4LogicalVolume*, Entry> fVolumes;
+    std::unordered_map<const G4ParticleDefinition*, Entry> fParticles;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
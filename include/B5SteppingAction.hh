@@ -0,0 +1,67 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5SteppingAction.hh
+/// \brief Definition of the B5SteppingAction class
+
+#ifndef B5SteppingAction_h
+#define B5SteppingAction_h 1
+
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+class B5StepProfiler;
+class G4VPhysicalVolume;
+
+/// Stepping action
+///
+/// In the tracking-only mode (/B5/detector/trackingOnly) the tracks are 
+/// killed when they enter the second arm, so that no time is spent on 
+/// the showers in the calorimeters which are not read out.
+/// The steps are also passed to the step profiler (/B5/profile/steps).
+/// Both settings are read at the start of each run, see BeginOfRun().
+
+class B5SteppingAction : public G4UserSteppingAction
+{
+  public:
+    B5SteppingAction();
+    virtual ~B5SteppingAction();
+
+    virtual void UserSteppingAction(const G4Step*);
+
+    // called from B5RunAction::BeginOfRunAction()
+    void BeginOfRun();
+
+  private:
+    B5StepProfiler* fProfiler;
+    const G4VPhysicalVolume* fSecondArm;
+    G4bool fTrackingOnly;
+    G4bool fProfiling;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5SweepManager.hh
+/// \brief Definition of the B5SweepManager class
+
+#ifndef B5SweepManager_h
+#define B5SweepManager_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+
+/// Configuration sweep (/B5/sweep/ commands)
+///
+/// Runs a list of (particle, momentum, field, arm angle, events) points 
+/// in one job, reusing the initialised geometry and physics tables. 
+/// The points are run ordered by arm angle, so that the geometry is 
+/// modified only when the angle changes; the events of each point are 
+/// shared by all workers as in any run.
+///
+/// Each point is identified by its index in the list, the configuration 
+/// ID, which is set with /B5/output/configID and written in the ConfigID 
+/// column of the ntuples. The output of each point goes to 
+/// <name>_c<ID>.root and the points are listed in <name>_sweep.csv, 
+/// so that the files can be merged (hadd) and selected by ConfigID.
+///
+/// The generator, field, arm angle and output settings changed by the 
+/// sweep are restored when it ends, also after a failed command.
+///
+/// Runs on master only.
+
+class B5SweepManager : public G4UImessenger
+{
+  public:
+    B5SweepManager();
+    virtual ~B5SweepManager();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+    void AddPoint(const G4String& particle, G4double momentum, 
+                  G4double field, G4double armAngle, G4int nofEvents);
+    void ReadFile(const G4String& fileName);
+    void Clear() { fPoints.clear(); }
+    void List() const;
+    void Run();
+
+  private:
+    struct Point {
+      G4String fParticle;
+      G4double fMomentum;
+      G4double fField;
+      G4double fArmAngle;
+      G4int fNofEvents;
+    };
+
+    std::vector<std::size_t> GetRunOrder() const;
+    G4bool Apply(const G4String& command) const;
+
+    std::vector<Point> fPoints;
+
+    G4UIdirectory* fDirectory;
+    G4UIcommand* fAddPointCmd;
+    G4UIcmdWithAString* fReadFileCmd;
+    G4UIcmdWithoutParameter* fClearCmd;
+    G4UIcmdWithoutParameter* fListCmd;
+    G4UIcmdWithoutParameter* fRunCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,117 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TensorWriter.hh
+/// \brief Definition of the B5TensorWriter class
+
+#ifndef B5TensorWriter_h
+#define B5TensorWriter_h 1
+
+#include "globals.hh"
+
+#include <cstdio>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Training tensor writer
+///
+/// Writes fixed-shape training samples directly from the simulation: 
+/// one sample per primary track, made of the (x, z) positions of its 
+/// first ntime drift chamber 1 hits and labelled with its angle at the 
+/// reference chamber. Tracks with fewer hits or without a reference hit 
+/// are skipped.
+///
+/// Each worker thread writes its own shard, <prefix>_r<run>_t<thread>.tensor,
+/// in chunks of samples; the master writes the manifest 
+/// <prefix>_r<run>.tensor.manifest. The shards can be memory-mapped 
+/// as float32 arrays of shape (nsamples, ntime*ninput + 1).
+///
+/// Shard layout (all values little-endian):
+/// - header (32 bytes): "B5TS", uint32 version (1), uint32 ntime, 
+///   uint32 ninput (2), uint32 samples per chunk, uint32 reserved, 
+///   uint64 number of samples
+/// - samples: float32 x, z (mm) for each time step, float32 angle (rad)
+///
+/// The writer is enabled with /B5/output/tensor <prefix>.
+
+class B5TensorWriter
+{
+  public:
+    ~B5TensorWriter();
+
+    static B5TensorWriter* Instance();
+
+    void Open(G4int runID);
+    void Close();
+    G4bool IsOpen() const { return fFile != nullptr; }
+
+    void BeginSample();
+    G4bool AddStep(G4double x, G4double z);
+    void EndSample(G4double label);
+
+    static void WriteManifest(G4int runID);
+
+    void SetPrefix(const G4String& val);
+    const G4String& GetPrefix() const { return fPrefix; }
+    G4bool IsEnabled() const { return ! fPrefix.empty(); }
+
+    static constexpr G4int kNofInputs = 2;
+    static constexpr std::size_t kHeaderSize = 32;
+
+  private:
+    B5TensorWriter();
+
+    void DefineCommands();
+    void WriteChunk();
+
+    static G4ThreadLocal B5TensorWriter* fgInstance;
+    // shards written in this process (file name, number of samples)
+    static std::mutex fgShardMutex;
+    static std::vector<std::pair<G4String, G4long>> fgShards;
+
+    G4GenericMessenger* fMessenger;
+    G4String fPrefix;
+    G4int fNofTimeSteps;
+    G4int fChunkSize;
+
+    std::FILE* fFile;
+    G4String fFileName;
+    G4long fNofSamples;
+    G4long fNofSkipped;
+
+    // sample being filled and samples of the current chunk
+    std::vector<float> fSample;
+    G4int fNofSteps;
+    std::vector<unsigned char> fChunk;
+    G4int fNofChunkSamples;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5ThreadClock.hh
+/// \brief Thread CPU time for the B5 profilers
+
+#ifndef B5ThreadClock_h
+#define B5ThreadClock_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <time.h>
+
+// CPU time used by the calling thread, in seconds, so that the time 
+// when the thread is preempted or waits on I/O is not counted. 
+// Without a thread CPU clock the steady (wall) clock is used instead.
+
+#ifdef CLOCK_THREAD_CPUTIME_ID
+constexpr G4bool kB5ThreadClockIsCpu = true;
+
+inline G4double B5ThreadClockSeconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec + 1.e-9*now.tv_nsec;
+}
+#else
+constexpr G4bool kB5ThreadClockIsCpu = false;
+
+inline G4double B5ThreadClockSeconds()
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
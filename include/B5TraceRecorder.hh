@@ -0,0 +1,141 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TraceRecorder.hh
+/// \brief Definition of the B5TraceRecorder class
+
+#ifndef B5TraceRecorder_h
+#define B5TraceRecorder_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Event timeline recorder
+///
+/// Records the begin and end time of each event and of its phases 
+/// (generate primaries, tracking, SD end of event, histogram fill, 
+/// ntuple fill, hit stream and tensor writes) and of the run actions 
+/// into a ring buffer per thread, which keeps the last 
+/// /B5/profile/traceBuffer spans without locking.
+/// The tracking phase ends with the last track of the event; the time 
+/// until EndOfEventAction is spent in the SD end of event, which includes
+/// the pair histograms (B5HoughAccumulator). The histogram fill phase 
+/// covers the drift chamber histograms of EndOfEventAction, the ntuple 
+/// fill phase all ntuple columns and rows (B5 and B5Hits).
+///
+/// At the end of run each thread adds its spans to the run list and the
+/// master writes them to <prefix>_r<run>.json in the Chrome trace event 
+/// format (chrome://tracing, Perfetto), one row per thread.
+///
+/// The recorder is enabled with /B5/profile/trace <prefix>.
+
+class B5TraceRecorder
+{
+  public:
+    enum Phase { 
+      kEvent, kGeneratePrimaries, kTracking, kSDEndOfEvent, 
+      kHistogramFill, kNtupleFill, kOutputWrite, kBeginOfRun, kEndOfRun, 
+      kNofPhases 
+    };
+
+    ~B5TraceRecorder();
+
+    static B5TraceRecorder* Instance();
+
+    // Clock in ns
+    static G4long Now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Open();
+    void Record(Phase phase, G4long begin, G4long end, G4int eventID = -1);
+
+    // Event phases, in the order of the calls
+    void BeginEvent() { if (fEnabled) fEventBegin = Now(); }
+    void EndGeneratePrimaries(G4int eventID);
+    void BeginTracking() { if (fEnabled) fTrackingBegin = fTrackEnd = Now(); }
+    void EndTrack() { if (fEnabled) fTrackEnd = Now(); }
+    void BeginEndOfEvent();
+    void EndHistogramFill();
+    void EndNtupleFill();
+    void EndOutputWrite();
+
+    // Add the spans of this thread to the run list
+    void Merge();
+    // Write and reset the run list
+    static void Write(G4int runID);
+
+    void SetPrefix(const G4String& val);
+    const G4String& GetPrefix() const { return fPrefix; }
+    G4bool IsEnabled() const { return fEnabled; }
+
+  private:
+    B5TraceRecorder();
+
+    void DefineCommands();
+
+    struct Span {
+      G4int fPhase;
+      G4int fThread;
+      G4int fEventID;
+      G4long fBegin;
+      G4long fEnd;
+    };
+
+    static G4ThreadLocal B5TraceRecorder* fgInstance;
+    // spans of all threads in this run and the number overwritten
+    static std::mutex fgMutex;
+    static std::vector<Span> fgSpans;
+    static G4long fgNofLost;
+
+    G4GenericMessenger* fMessenger;
+    G4String fPrefix;
+    G4bool fEnabled;
+    G4int fBufferSize;
+
+    // ring buffer, fNofSpans recorded in total
+    std::vector<Span> fRing;
+    G4long fNofSpans;
+    G4int fThread;
+
+    G4int fEventID;
+    G4long fEventBegin;
+    G4long fTrackingBegin;
+    G4long fTrackEnd;
+    G4long fEndOfEventBegin;
+    G4long fHistogramEnd;
+    G4long fNtupleEnd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
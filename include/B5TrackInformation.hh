@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TrackInformation.hh
+/// \brief Definition of the B5TrackInformation class
+
+#ifndef B5TrackInformation_h
+#define B5TrackInformation_h 1
+
+#include "G4VUserTrackInformation.hh"
+#include "G4Allocator.hh"
+#include "globals.hh"
+
+/// Track information
+///
+/// It records the index of the primary track (in generation order)
+/// the track descends from. It is attached to primaries and passed to
+/// their secondaries by B5TrackingAction.
+/// It also records the stacking rule which classified the track, so 
+/// that its steps and CPU time are attributed to the rule; this one is 
+/// set by B5StackingAction and is not passed to the secondaries.
+
+class B5TrackInformation : public G4VUserTrackInformation
+{
+  public:
+    B5TrackInformation(G4int trackIndex);
+    B5TrackInformation(const B5TrackInformation& right);
+    virtual ~B5TrackInformation();
+
+    inline void *operator new(size_t);
+    inline void operator delete(void *info);
+
+    virtual void Print() const;
+
+    G4int GetTrackIndex() const { return fTrackIndex; }
+
+    // no rule (primaries, or no rules defined)
+    static constexpr G4int kNoStackingRule = -2;
+    // secondaries matching no rule
+    static constexpr G4int kOtherStackingRule = -1;
+
+    void SetStackingRule(G4int rule) { fStackingRule = rule; }
+    G4int GetStackingRule() const { return fStackingRule; }
+
+  private:
+    G4int fTrackIndex;
+    G4int fStackingRule;
+};
+
+extern G4ThreadLocal 
+  G4Allocator<B5TrackInformation>* B5TrackInformationAllocator;
+
+inline void* B5TrackInformation::operator new(size_t)
+{
+  if (!B5TrackInformationAllocator) {
+       B5TrackInformationAllocator = new G4Allocator<B5TrackInformation>;
+  }
+  return (void*)B5TrackInformationAllocator->MallocSingle();
+}
+
+inline void B5TrackInformation::operator delete(void* info)
+{
+  B5TrackInformationAllocator->FreeSingle((B5TrackInformation*) info);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,67 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TrackingAction.hh
+/// \brief Definition of the B5TrackingAction class
+
+#ifndef B5TrackingAction_h
+#define B5TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+class B5StepProfiler;
+class B5TraceRecorder;
+
+/// Tracking action
+///
+/// Attaches a B5TrackInformation with the primary track index to each
+/// primary track and copies it to the secondaries, so that hits can be
+/// associated with the generated track they come from.
+/// It also starts the step clock of the B5StepProfiler for each track
+/// and marks the end of each track for the B5TraceRecorder.
+/// The steps and CPU time of the tracks classified by a stacking rule 
+/// are reported to the B5StackingAction.
+
+class B5TrackingAction : public G4UserTrackingAction
+{
+  public:
+    B5TrackingAction();
+    virtual ~B5TrackingAction();
+
+    virtual void PreUserTrackingAction(const G4Track*);
+    virtual void PostUserTrackingAction(const G4Track*);
+
+  private:
+    B5StepProfiler* fProfiler;
+    B5TraceRecorder* fTraceRecorder;
+    // start time of the current track with a stacking rule
+    G4double fTrackStartTime;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -31,24 +31,48 @@
 #include "B5PrimaryGeneratorAction.hh"
 #include "B5RunAction.hh"
 #include "B5EventAction.hh"
+#include "B5TrackingAction.hh"
+#include "B5SteppingAction.hh"
+#include "B5StackingAction.hh"
+#include "B5SweepManager.hh"
+#include "B5Log.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B5ActionInitialization::B5ActionInitialization()
- : G4VUserActionInitialization()
-{}
+B5ActionInitialization::B5ActionInitialization(G4bool perWorkerFiles)
+ : G4VUserActionInitialization(),
+   fLogMessenger(nullptr),
+   fStackingMessenger(nullptr),
+   fSweepManager(nullptr),
+   fPerWorkerFiles(perWorkerFiles),
+   fMasterEventAction(nullptr)
+{
+  // the log level is shared by all threads: define its commands on master
+  fLogMessenger = new B5LogMessenger();
+  // as are the stacking rules
+  fStackingMessenger = new B5StackingMessenger();
+  // the sweep drives the runs from master
+  fSweepManager = new B5SweepManager();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B5ActionInitialization::~B5ActionInitialization()
-{}
+{
+  delete fLogMessenger;
+  delete fStackingMessenger;
+  delete fSweepManager;
+  delete fMasterEventAction;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B5ActionInitialization::BuildForMaster() const
 {
-  B5EventAction* eventAction = new B5EventAction;
-  SetUserAction(new B5RunAction(eventAction));
+  // The master processes no events; its event action only provides 
+  // the vectors the ntuple columns are bound to
+  fMasterEventAction = new B5EventAction;
+  SetUserAction(new B5RunAction(fMasterEventAction, nullptr, fPerWorkerFiles));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -60,7 +84,14 @@ void B5ActionInitialization::Build() const
   auto eventAction = new B5EventAction;
   SetUserAction(eventAction);
 
-  SetUserAction(new B5RunAction(eventAction));
+  auto steppingAction = new B5SteppingAction;
+  SetUserAction(steppingAction);
+
+  SetUserAction(new B5RunAction(eventAction, steppingAction, fPerWorkerFiles));
+
+  SetUserAction(new B5TrackingAction);
+
+  SetUserAction(new B5StackingAction);
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,6 +29,9 @@
 
 #include "B5DetectorConstruction.hh"
 #include "B5MagneticField.hh"
+#include "B5FieldSetup.hh"
+#include "B5FastShowerSetup.hh"
+#include "B5RegionCutMessenger.hh"
 #include "B5CellParameterisation.hh"
 #include "B5HodoscopeSD.hh"
 #include "B5DriftChamberSD.hh"
@@ -53,6 +56,8 @@
 #include "G4PVParameterised.hh"
 #include "G4PVReplica.hh"
 #include "G4UserLimits.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 
 #include "G4SDManager.hh"
 #include "G4VSensitiveDetector.hh"
@@ -68,13 +73,15 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4ThreadLocal B5MagneticField* B5DetectorConstruction::fMagneticField = 0;
-G4ThreadLocal G4FieldManager* B5DetectorConstruction::fFieldMgr = 0;
+G4ThreadLocal B5FieldSetup* B5DetectorConstruction::fFieldSetup = 0;
+G4ThreadLocal B5FastShowerSetup* B5DetectorConstruction::fFastShowerSetup = 0;
     
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B5DetectorConstruction::B5DetectorConstruction()
 : G4VUserDetectorConstruction(), 
   fMessenger(nullptr),
+  fRegionCutMessenger(nullptr),
   fHodoscope1Logical(nullptr),
   // fHodoscope2Logical(nullptr),
   fWirePlane1Logical(nullptr),
@@ -82,7 +89,8 @@ B5DetectorConstruction::B5DetectorConstruction()
   fCellLogical(nullptr), fHadCalScintiLogical(nullptr),
   fMagneticLogical(nullptr),
   fVisAttributes(),
-  fArmAngle(30.*deg), fArmRotation(nullptr), fSecondArmPhys(nullptr)
+  fArmAngle(30.*deg), fArmRotation(nullptr), fSecondArmPhys(nullptr),
+  fTrackingOnly(false)
 
 {
   fArmRotation = new G4RotationMatrix();
@@ -98,6 +106,7 @@ B5DetectorConstruction::~B5DetectorConstruction()
 {
   delete fArmRotation;
   delete fMessenger;
+  delete fRegionCutMessenger;
   
   for (auto visAttributes: fVisAttributes) {
     delete visAttributes;
@@ -271,6 +280,10 @@ G4VPhysicalVolume* B5DetectorConstruction::Construct()
   new G4PVPlacement(0,G4ThreeVector(0.,0.,2.*m),emCalorimeterLogical,
                     "EMcalorimeterPhysical",secondArmLogical,
                     false,0,checkOverlaps);
+
+  // the calorimeter is the envelope of the fast shower model
+  auto emCalRegion = new G4Region("EMCal");
+  emCalRegion->AddRootLogicalVolume(emCalorimeterLogical);
   
   // EMcalorimeter cells
   auto cellSolid 
@@ -324,6 +337,22 @@ G4VPhysicalVolume* B5DetectorConstruction::Construct()
                     "HadCalScintiPhysical",HadCalLayerLogical,
                     false,0,checkOverlaps);
   
+  // regions -----------------------------------------------------------------
+  // with their own production cuts set by /B5/region/cut
+  // (the EMCal region is defined with the EM calorimeter above)
+  
+  auto trackerRegion = new G4Region("Tracker");
+  trackerRegion->AddRootLogicalVolume(chamber1Logical);
+  trackerRegion->AddRootLogicalVolume(chamberFLogical);
+
+  auto scintillatorRegion = new G4Region("Scintillator");
+  scintillatorRegion->AddRootLogicalVolume(fHodoscope1Logical);
+  scintillatorRegion->AddRootLogicalVolume(fHodoscope2Logical);
+  scintillatorRegion->AddRootLogicalVolume(fHadCalScintiLogical);
+
+  auto hadCalRegion = new G4Region("HadCal");
+  hadCalRegion->AddRootLogicalVolume(hadCalorimeterLogical);
+  
   // visualization attributes ------------------------------------------------
   
   auto visAttributes = new G4VisAttributes(G4Colour(1.0,1.0,1.0));
@@ -402,11 +431,13 @@ void B5DetectorConstruction::ConstructSDandField()
   sdManager->AddNewDetector(hodoscope2);
   fHodoscope2Logical->SetSensitiveDetector(hodoscope2);
   
-  auto chamber1 = new B5DriftChamberSD(SDname="/chamber1");
+  auto chamber1 
+    = new B5DriftChamberSD(SDname="/chamber1", B5DriftChamberSD::kTrackingPlane);
   sdManager->AddNewDetector(chamber1);
   fWirePlane1Logical->SetSensitiveDetector(chamber1);
 
-  auto chamberF = new B5DriftChamberSD(SDname="/chamberF");
+  auto chamberF 
+    = new B5DriftChamberSD(SDname="/chamberF", B5DriftChamberSD::kReferencePlane);
   sdManager->AddNewDetector(chamberF);
   fWirePlaneFLogical->SetSensitiveDetector(chamberF);
 
@@ -422,13 +453,18 @@ void B5DetectorConstruction::ConstructSDandField()
   sdManager->AddNewDetector(hadCalorimeter);
   fHadCalScintiLogical->SetSensitiveDetector(hadCalorimeter);
 
+  // fast shower model -------------------------------------------------------
+  auto emCalRegion = G4RegionStore::GetInstance()->GetRegion("EMCal");
+  fFastShowerSetup 
+    = new B5FastShowerSetup(emCalRegion, 
+                            G4Material::GetMaterial("G4_CESIUM_IODIDE"));
+
   // magnetic field ----------------------------------------------------------
   fMagneticField = new B5MagneticField();
-  fFieldMgr = new G4FieldManager();
-  fFieldMgr->SetDetectorField(fMagneticField);
-  fFieldMgr->CreateChordFinder(fMagneticField);
+  fFieldSetup = new B5FieldSetup(fMagneticField);
   G4bool forceToAllDaughters = true;
-  fMagneticLogical->SetFieldManager(fFieldMgr, forceToAllDaughters);
+  fMagneticLogical->SetFieldManager(fFieldSetup->GetFieldManager(), 
+                                    forceToAllDaughters);
 }    
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -492,6 +528,26 @@ void B5DetectorConstruction::SetArmAngle(G4double val)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B5DetectorConstruction::SetTrackingOnly(G4bool val)
+{
+  // The sensitive detectors are switched at the next run start,
+  // see ActivateSensitiveDetectors()
+  fTrackingOnly = val;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5DetectorConstruction::ActivateSensitiveDetectors() const
+{
+  // The SD manager is thread-local, so this is called by each thread
+  auto sdManager = G4SDManager::GetSDMpointer();
+  for (auto name : { "/hodoscope2", "/EMcalorimeter", "/HadCalorimeter" }) {
+    sdManager->Activate(name, ! fTrackingOnly);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void B5DetectorConstruction::DefineCommands()
 {
   // Define /B5/detector command directory using generic messenger class
@@ -507,6 +563,18 @@ void B5DetectorConstruction::DefineCommands()
   armAngleCmd.SetParameterName("angle", true);
   armAngleCmd.SetRange("angle>=0. && angle<180.");
   armAngleCmd.SetDefaultValue("30.");
+
+  // trackingOnly command
+  auto& trackingOnlyCmd
+    = fMessenger->DeclareMethod("trackingOnly",
+                                &B5DetectorConstruction::SetTrackingOnly, 
+                                "Kill the tracks entering the second arm and "
+                                "switch off its detectors.");
+  trackingOnlyCmd.SetParameterName("flag", true);
+  trackingOnlyCmd.SetDefaultValue("true");
+
+  // Define /B5/region commands
+  fRegionCutMessenger = new B5RegionCutMessenger();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
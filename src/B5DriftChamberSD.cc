@@ -28,7 +28,11 @@
 /// \brief Implementation of the B5DriftChamber class
 
 #include "B5DriftChamberSD.hh"
+#include "B5PerfCounters.hh"
 #include "B5DriftChamberHit.hh"
+#include "B5HoughAccumulator.hh"
+#include "B5TrackInformation.hh"
+#include "B5Log.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
@@ -42,26 +46,23 @@
 #include "g4analysis.hh"
 #include "G4RunManager.hh"
 
-static FILE* myfile;
-
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B5DriftChamberSD::B5DriftChamberSD(G4String name)
+B5DriftChamberSD::B5DriftChamberSD(G4String name, Role role)
 : G4VSensitiveDetector(name), 
-  fHitsCollection(nullptr), fHCID(-1)
+  fRole(role), fHitsCollection(nullptr), fHCID(-1),
+  fPerfCounters(B5PerfCounters::Instance())
 {
   collectionName.insert("driftChamberColl");
-  if(strcmp(this->GetName().c_str(),"chamber1") == 0){
-    // myfile = (FILE *) fopen("data.txt","w");
-    myfile = (FILE *) fopen("data.csv","w");
-  }
+  // create the thread-local accumulator (and its commands)
+  B5HoughAccumulator::Instance();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B5DriftChamberSD::~B5DriftChamberSD()
 {
-  printf("destructing\n");
+  B5_DEBUG("destructing %s", GetName().c_str());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -76,52 +77,32 @@ void B5DriftChamberSD::Initialize(G4HCofThisEvent* hce){
   }
   hce->AddHitsCollection(fHCID,fHitsCollection);
   // printf("initalize1 %s\n",this->GetName().c_str());
-  hits.clear();
+  fHitX.clear();
+  fHitZ.clear();
   momentum_h = 0;
-
-  auto analysisManager = G4AnalysisManager::Instance();
-
-  HistA = analysisManager->GetH1Id("HistA");
-  HistB = analysisManager->GetH1Id("HistB");
-  HistAB = analysisManager->GetH2Id("HistAB");
   // printf("init: %s\n",this->GetName().c_str());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 
-G4bool B5DriftChamberSD::ProcessHits(G4Step* step, G4TouchableHistory*){
-  auto charge = step->GetTrack()->GetDefinition()->GetPDGCharge();
-  if (charge==0.) return true;
-  
-  auto preStepPoint = step->GetPreStepPoint();
+G4bool B5DriftChamberSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  B5PerfCounters::SDScope perfScope(fPerfCounters);
 
-  // step->GetTrack()[0].Get 
+  return (fRole == kReferencePlane) ? ProcessReferenceHit(step) 
+                                    : ProcessTrackingHit(step);
+}
 
-  auto touchable = step->GetPreStepPoint()->GetTouchable();
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5DriftChamberHit* B5DriftChamberSD::CreateHit(const G4Step* step) const
+{
+  auto preStepPoint = step->GetPreStepPoint();
+  auto touchable = preStepPoint->GetTouchable();
   auto motherPhysical = touchable->GetVolume(1); // mother
   auto copyNo = motherPhysical->GetCopyNo();
-  auto a = step->GetTrack()[0].GetPosition().x();
-  auto b = step->GetTrack()[0].GetPosition().y();
-  auto c = step->GetTrack()[0].GetPosition().z();
-  auto angle_a = step->GetTrack()[0].GetMomentumDirection().x();
-  auto angle_b = step->GetTrack()[0].GetMomentumDirection().y();
-  auto angle_c = step->GetTrack()[0].GetMomentumDirection().z();
-  // printf("name: %s\n",this->GetName().c_str());
-  // printf("  pos: %f %f %f\n",a,b,c);
-  // printf("  ang: %f %f %f\n",angle_a,angle_b,angle_c);
   auto worldPos = preStepPoint->GetPosition();
-  auto momentum = preStepPoint->GetMomentum().mag();
-  
-  auto hit_id = preStepPoint->GetTouchableHandle()->GetCopyNumber(1);
-  auto hit_name = preStepPoint->GetTouchableHandle()->GetVolume()->GetName();
-  // if(strcmp(hit_name.c_str(),"wirePlane1Physical") == 0)
-  // if(strcmp(this->GetName().c_str(),"chamber1") == 0){
-    // printf("name:%s|id:%d world pos: %8.2f %6.2f %7.2f | p=%4.2f\n",hit_name.c_str(),hit_id, worldPos.x(),worldPos.y(),worldPos.z(),momentum/CLHEP::GeV);
-  momentum_h = momentum/CLHEP::GeV;
-  hits.push_back(worldPos);
-  // }
-
   auto localPos 
     = touchable->GetHistory()->GetTopTransform().TransformPoint(worldPos);
   
@@ -129,75 +110,77 @@ G4bool B5DriftChamberSD::ProcessHits(G4Step* step, G4TouchableHistory*){
   hit->SetWorldPos(worldPos);
   hit->SetLocalPos(localPos);
   hit->SetTime(preStepPoint->GetGlobalTime());
-  hit->SetMomentum(momentum_h);
-
-  if(strcmp(this->GetName().c_str(),"chamberF") == 0){
-    double x_m = preStepPoint->GetMomentum().x();
-    double z_m = preStepPoint->GetMomentum().z();
-    // double angle = atan2(z_m,x_m);
-    double angle = atan2(x_m,z_m);
-    hit->SetInitAngle(angle);
-    printf("setting init angle %frad, %fdeg\n",angle,angle*(180/M_PI));
-  } else {
-    hit->SetInitAngle(0);
-  }
+  hit->SetMomentum(preStepPoint->GetMomentum().mag()/CLHEP::GeV);
+
+  auto info = static_cast<B5TrackInformation*>(
+                step->GetTrack()->GetUserInformation());
+  if ( info ) hit->SetTrackIndex(info->GetTrackIndex());
+  return hit;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5DriftChamberSD::ProcessTrackingHit(G4Step* step)
+{
+  auto charge = step->GetTrack()->GetDefinition()->GetPDGCharge();
+  if (charge==0.) return true;
 
+  auto hit = CreateHit(step);
+  momentum_h = hit->GetMomentum();
+  fHitX.push_back(hit->GetWorldPos().x());
+  fHitZ.push_back(hit->GetWorldPos().z());
+  hit->SetInitAngle(0);
 
+  fHitsCollection->insert(hit);
   
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5DriftChamberSD::ProcessReferenceHit(G4Step* step)
+{
+  auto charge = step->GetTrack()->GetDefinition()->GetPDGCharge();
+  if (charge==0.) return true;
+
+  auto hit = CreateHit(step);
+  momentum_h = hit->GetMomentum();
+
+  auto momentum = step->GetPreStepPoint()->GetMomentum();
+  double x_m = momentum.x();
+  double z_m = momentum.z();
+  // double angle = atan2(z_m,x_m);
+  double angle = atan2(x_m,z_m);
+  hit->SetInitAngle(angle);
+  B5_DEBUG("setting init angle %frad, %fdeg",angle,angle*(180/M_PI));
+
   fHitsCollection->insert(hit);
   
   return true;
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B5DriftChamberSD::EndOfEvent(G4HCofThisEvent*HCE){
   // printf(":%s:\n",this->GetName().c_str());
   // printf("cur:");
-  // for(int z = 0; z < hits.size(); z++){
-  //   printf("  %f,%f,%f\n",hits[z].x(),hits[z].y(),hits[z].z());
+  // for(int z = 0; z < fHitX.size(); z++){
+  //   printf("  %f,%f\n",fHitX[z],fHitZ[z]);
   // }
   // printf("\n");
-  // printf("hits size:%d\n",hits.size());
+  // printf("hits size:%d\n",fHitX.size());
 
-  if(strcmp(this->GetName().c_str(),"chamberF") == 0){
+  if (fRole == kReferencePlane) {
     // printf("fin\n");
     return;
   }
 
-  auto analysisManager = G4AnalysisManager::Instance();
-
-  std::vector<double> angles;
-  int ctr = 0;
-  for(int i = 0; i < hits.size() - 1; i++){
-    for(int j = i+1; j < hits.size(); j++){
-      auto diff_x = hits[i].x() - hits[j].x();
-      auto diff_z = hits[i].z() - hits[j].z();
-      // auto angle = diff_z/diff_x;
-      auto angle = atan2(diff_z,diff_x);
-      auto b = hits[i].z() - (diff_z/diff_x) * hits[i].x();
-      analysisManager->FillH1(HistA,angle);
-      analysisManager->FillH1(HistB,b);
-      analysisManager->FillH2(HistAB,angle,b);
-      // 300, -1.8, -1.4
-      float gap = 0.4 / 300.;
-      float diff = angle + 1.8;
-      float id_f = diff / gap;
-      // printf("loc id: %f = %d\n",id_f,int(id_f));
-      // printf("id: %d, %d = %d\n",i,j,ctr++);
-      // printf("  a: %f\n",angle);
-      // printf("  b: %f\n",b);
-    }
-  }
+  // pairwise angle/intercept histograms
+  B5HoughAccumulator::Instance()->AddEvent(fHitX.data(), fHitZ.data(), 
+                                           fHitX.size());
 
   // printf("fin\n");
 
-
-  // fprintf((FILE *)myfile,"%.2f",current[0]);
-  // for(int z = 1; z < current.size(); z+=3){
-  //   // fprintf((FILE *)myfile," %8.2f %6.2f %8.2f",current[z],current[z+1],current[z+2]);
-  //   fprintf(myfile,",%.2f,%.2f,%.2f",current[z],current[z+1],current[z+2]);
-  // }
-  // fprintf(myfile,"\n");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
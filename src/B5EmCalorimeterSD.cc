@@ -28,13 +28,16 @@
 /// \brief Implementation of the B5EmCalorimeterSD class
 
 #include "B5EmCalorimeterSD.hh"
+#include "B5PerfCounters.hh"
 #include "B5EmCalorimeterHit.hh"
 #include "B5Constants.hh"
+#include "B5Log.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
 #include "G4Track.hh"
 #include "G4Step.hh"
+#include "G4GFlashSpot.hh"
 #include "G4SDManager.hh"
 #include "G4ios.hh"
 
@@ -42,7 +45,8 @@
 
 B5EmCalorimeterSD::B5EmCalorimeterSD(G4String name)
 : G4VSensitiveDetector(name), 
-  fHitsCollection(nullptr), fHCID(-1)
+  fHitsCollection(nullptr), fHCID(-1), fCellStore(),
+  fPerfCounters(B5PerfCounters::Instance())
 {
   collectionName.insert("EMcalorimeterColl");
 }
@@ -63,37 +67,79 @@ void B5EmCalorimeterSD::Initialize(G4HCofThisEvent* hce)
   }
   hce->AddHitsCollection(fHCID,fHitsCollection);
   
-  // fill calorimeter hits with zero energy deposition
-  for (auto i=0;i<kNofEmCells;i++) {
-    fHitsCollection->insert(new B5EmCalorimeterHit(i));
-  }
+  // reset the cells touched in the previous event
+  fCellStore.Reset();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4bool B5EmCalorimeterSD::ProcessHits(G4Step*step, G4TouchableHistory*)
 {
+  B5PerfCounters::SDScope perfScope(fPerfCounters);
+
   auto edep = step->GetTotalEnergyDeposit();
   if (edep==0.) return true;
   
   auto touchable = step->GetPreStepPoint()->GetTouchable();
-  auto physical = touchable->GetVolume();
-  auto copyNo = physical->GetCopyNo();
+  auto copyNo = touchable->GetVolume()->GetCopyNo();
+  AddEdep(edep, touchable, copyNo);
   
-  auto hit = (*fHitsCollection)[copyNo];
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5EmCalorimeterSD::ProcessHits(G4GFlashSpot*spot, G4TouchableHistory*)
+{
+  B5PerfCounters::SDScope perfScope(fPerfCounters);
+
+  auto edep = spot->GetEnergySpot()->GetEnergy();
+  if (edep==0.) return true;
+  
+  // the cells are parameterised: take the copy number from the touchable 
+  // of the spot, not from the shared physical volume
+  auto touchable = spot->GetTouchableHandle();
+  AddEdep(edep, touchable(), touchable->GetReplicaNumber());
+  
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5EmCalorimeterSD::AddEdep(G4double edep, 
+                                const G4VTouchable* touchable, G4int copyNo)
+{
+  G4bool isFirst;
+  auto& cell = fCellStore.Touch(copyNo, isFirst);
   // check if it is first touch
-  if (!(hit->GetLogV())) {
+  if (isFirst) {
     // fill volume information
-    hit->SetLogV(physical->GetLogicalVolume());
+    cell.fPLogV = touchable->GetVolume()->GetLogicalVolume();
     G4AffineTransform transform = touchable->GetHistory()->GetTopTransform();
     transform.Invert();
-    hit->SetRot(transform.NetRotation());
-    hit->SetPos(transform.NetTranslation());
+    cell.fRot = transform.NetRotation();
+    cell.fPos = transform.NetTranslation();
   }
   // add energy deposition
-  hit->AddEdep(edep);
-  
-  return true;
+  cell.fEdep += edep;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5EmCalorimeterSD::EndOfEvent(G4HCofThisEvent*)
+{
+  // export the touched cells only
+  for (auto cellID : fCellStore.GetDirtyCells()) {
+    const auto& cell = fCellStore.GetCell(cellID);
+    auto hit = new B5EmCalorimeterHit(cellID);
+    hit->SetEdep(cell.fEdep);
+    hit->SetLogV(cell.fPLogV);
+    hit->SetRot(cell.fRot);
+    hit->SetPos(cell.fPos);
+    fHitsCollection->insert(hit);
+  }
+  B5_DEBUG("%s: %zu touched cells", GetName().c_str(), 
+           fCellStore.GetDirtyCells().size());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
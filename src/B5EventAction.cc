@@ -33,6 +33,12 @@
 #include "B5EmCalorimeterHit.hh"
 #include "B5HadCalorimeterHit.hh"
 #include "B5Constants.hh"
+#include "B5Log.hh"
+#include "B5HitStreamWriter.hh"
+#include "B5TensorWriter.hh"
+#include "B5TraceRecorder.hh"
+#include "B5PerfCounters.hh"
+#include "B5MemoryReport.hh"
 
 #include "G4Event.hh"
 #include "G4RunManager.hh"
@@ -82,13 +88,23 @@ B5EventAction::B5EventAction()
   fDriftHCID{{ -1, -1 }},
   fCalHCID  {{ -1, -1 }},
   fDriftHistoID{{ {{ -1, -1 }}, {{ -1, -1 }} }},
-  fCalEdep{{ std::vector<G4double>(kNofEmCells, 0.), std::vector<G4double>(kNofHadCells, 0.) }}
+  fCalEdep{{ std::vector<G4double>(kNofEmCells, 0.), std::vector<G4double>(kNofHadCells, 0.) }},
+  fCalCellID(),
+  fTrackIndex(),
+  fTrackInitAngle(),
+  fTrackHasAngle(),
+  fHitsNtupleID(-1),
+  fTrackingOnly(false),
+  fConfigID(-1),
+  fTraceRecorder(B5TraceRecorder::Instance()),
+  fPerfCounters(B5PerfCounters::Instance()),
+  fMemoryReport(B5MemoryReport::Instance())
       // std::array<T, N> is an aggregate that contains a C array. 
       // To initialize it, we need outer braces for the class itself 
       // and inner braces for the C array
 {
-  // set printing per each event
-  G4RunManager::GetRunManager()->SetPrintProgress(1);
+  // printing per event is set with /run/printProgress,
+  // printing of the individual hits with /B5/log/level debug
   str_ctr = 0;
 }
 
@@ -99,8 +115,26 @@ B5EventAction::~B5EventAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+std::size_t B5EventAction::GetVectorBytes() const
+{
+  std::size_t bytes 
+    = ( pos_x_vector.capacity() + pos_y_vector.capacity() + 
+        pos_z_vector.capacity() + fTrackInitAngle.capacity() )*sizeof(double)
+      + fTrackIndex.capacity()*sizeof(G4int) 
+      + fTrackHasAngle.capacity()/8;
+  for (G4int iDet = 0; iDet < kDim; ++iDet) {
+    bytes += fCalEdep[iDet].capacity()*sizeof(G4double)
+           + fCalCellID[iDet].capacity()*sizeof(G4int);
+  }
+  return bytes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void B5EventAction::BeginOfEventAction(const G4Event*)
 {
+  fPerfCounters->BeginEvent();
+
   // Find hit collections and histogram Ids by names (just once)
   // and save them in the data members of this class
 
@@ -139,6 +173,9 @@ void B5EventAction::BeginOfEventAction(const G4Event*)
   pos_x_vector.clear();
   pos_y_vector.clear();
   pos_z_vector.clear();
+  fTrackIndex.clear();
+
+  fTraceRecorder->BeginTracking();
 }     
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -149,6 +186,8 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
   // Fill histograms & ntuple
   // 
 
+  fTraceRecorder->BeginEndOfEvent();
+
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
  
@@ -169,6 +208,7 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
       analysisManager->FillH2(fDriftHistoID[kH2][iDet], localPos.x(), localPos.y());
     }
   }
+  fTraceRecorder->EndHistogramFill();
       
   // Em/Had Calorimeters hits
   array<G4int, kDim> totalCalHit = {{ 0, 0 }}; 
@@ -176,30 +216,49 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
 
   // for (G4int iDet = 0; iDet < kDim; ++iDet) {
   for (G4int iDet = 0; iDet < 1; ++iDet) {
+    // only the touched cells are in the collection,
+    // so reset the cells filled in the previous event first
+    for (auto cellID : fCalCellID[iDet]) {
+      fCalEdep[iDet][cellID] = 0.;
+    }
+    fCalCellID[iDet].clear();
+
+    // the calorimeters are not read out in the tracking-only mode
+    if ( fTrackingOnly ) continue;
+
     auto hc = GetHC(event, fCalHCID[iDet]);
     if ( ! hc ) return;
 
-    totalCalHit[iDet] = 0;
-    totalCalEdep[iDet] = 0.;
     for (unsigned long i = 0; i < hc->GetSize(); ++i) {
       G4double edep = 0.;
+      G4int cellID = 0;
       // The EM and Had calorimeter hits are of different types
       if (iDet == 0) {
         auto hit = static_cast<B5EmCalorimeterHit*>(hc->GetHit(i));
         edep = hit->GetEdep();
+        cellID = hit->GetCellID();
       } else {
         auto hit = static_cast<B5HadCalorimeterHit*>(hc->GetHit(i));
         edep = hit->GetEdep();
+        cellID = kNofHadRows*hit->GetColumnID() + hit->GetRowID();
       }
       if ( edep > 0. ) {
         totalCalHit[iDet]++;
         totalCalEdep[iDet] += edep;
       }
-      fCalEdep[iDet][i] = edep;
+      fCalEdep[iDet][cellID] = edep;
+      fCalCellID[iDet].push_back(cellID);
     }
     // columns 2, 3
     analysisManager->FillNtupleDColumn(iDet + 2, totalCalEdep[iDet]);
   }
+  if ( fTrackingOnly ) {
+    // not read out: -1 in the energy columns 2, 3, so that it differs 
+    // from no deposit; the cell vectors stay zero-filled
+    for (G4int iDet = 0; iDet < kDim; ++iDet) {
+      analysisManager->FillNtupleDColumn(iDet + 2, -1.);
+    }
+  }
 
   // Hodoscopes hits
   // for (G4int iDet = 0; iDet < kDim; ++iDet) {
@@ -217,10 +276,20 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
   {
     // auto hc = GetHC(event, fDriftHCID[0]);
     auto hc = GetHC(event, fDriftHCID[1]);
+    // one angle per primary track, taken from its first reference hit
+    fTrackInitAngle.assign(event->GetNumberOfPrimaryVertex(), 0.);
+    fTrackHasAngle.assign(fTrackInitAngle.size(), false);
     for (unsigned long i = 0; i < hc->GetSize(); ++i) {
       auto hit = static_cast<B5DriftChamberHit*>(hc->GetHit(i));
-      printf("hit: %f\n",hit->GetInitAngle());
+      B5_DEBUG("hit: %f",hit->GetInitAngle());
       analysisManager->FillNtupleDColumn(12, hit->GetInitAngle());
+      auto trackIndex = hit->GetTrackIndex();
+      if ( trackIndex >= 0 && 
+           trackIndex < G4int(fTrackInitAngle.size()) &&
+           ! fTrackHasAngle[trackIndex] ) {
+        fTrackInitAngle[trackIndex] = hit->GetInitAngle();
+        fTrackHasAngle[trackIndex] = true;
+      }
     }
   }
 
@@ -229,29 +298,80 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
   pos_x_vector.clear();
   pos_y_vector.clear();
   pos_z_vector.clear();
+  fTrackIndex.clear();
 
   // printf("cleared vectors\n");
 
   {
     auto hc = GetHC(event, fDriftHCID[0]);
+    auto fillHits = ( fHitsNtupleID >= 0 && 
+                      analysisManager->GetNtupleActivation(fHitsNtupleID) );
     // printf("get size: %d\n",hc->GetSize());
     for (unsigned long i = 0; i < hc->GetSize(); ++i) {
       auto hit = static_cast<B5DriftChamberHit*>(hc->GetHit(i));
       pos_x_vector.push_back(hit->GetWorldPos().x());
       pos_y_vector.push_back(hit->GetWorldPos().y());
       pos_z_vector.push_back(hit->GetWorldPos().z());
+      fTrackIndex.push_back(hit->GetTrackIndex());
+      if ( fillHits ) {
+        auto id = fHitsNtupleID;
+        analysisManager->FillNtupleIColumn(id, 0, event->GetEventID());
+        analysisManager->FillNtupleIColumn(id, 1, hit->GetLayerID());
+        analysisManager->FillNtupleFColumn(id, 2, hit->GetWorldPos().x()/mm);
+        analysisManager->FillNtupleFColumn(id, 3, hit->GetWorldPos().y()/mm);
+        analysisManager->FillNtupleFColumn(id, 4, hit->GetWorldPos().z()/mm);
+        analysisManager->FillNtupleFColumn(id, 5, hit->GetTime()/ns);
+        analysisManager->FillNtupleFColumn(id, 6, hit->GetMomentum());
+        analysisManager->FillNtupleIColumn(id, 7, hit->GetTrackIndex());
+        analysisManager->FillNtupleIColumn(id, 8, fConfigID);
+        analysisManager->AddNtupleRow(id);
+      }
       // printf("pushed back\n");
       // printf("ctr: %d\n",str_ctr++);
       // printf("ctr2: %d\n",str_ctr2);
     }
   }
   str_ctr2++;
+
   // analysisManager->FillNtupleDColumn(8, pos_x_vector);
   // analysisManager->FillNtupleDColumn(9, pos_y_vector);
   // analysisManager->FillNtupleDColumn(10, pos_z_vector);
 
-  
+  // column 15
+  analysisManager->FillNtupleIColumn(15, fConfigID);
   analysisManager->AddNtupleRow();
+  fTraceRecorder->EndNtupleFill();
+
+  // Binary outputs
+  // The chamber 1 hits to the hit stream
+  auto hitStream = B5HitStreamWriter::Instance();
+  if ( hitStream->IsOpen() ) {
+    auto hc = GetHC(event, fDriftHCID[0]);
+    for (unsigned long i = 0; i < hc->GetSize(); ++i) {
+      auto hit = static_cast<B5DriftChamberHit*>(hc->GetHit(i));
+      hitStream->Write(event->GetEventID(), hit->GetLayerID(), 
+                       hit->GetWorldPos(), hit->GetTime(), hit->GetMomentum());
+    }
+  }
+
+  // Training samples: the first chamber 1 hits of each primary track
+  // labelled with its angle at the reference chamber
+  auto tensorWriter = B5TensorWriter::Instance();
+  if ( tensorWriter->IsOpen() ) {
+    for (std::size_t track = 0; track < fTrackInitAngle.size(); ++track) {
+      if ( ! fTrackHasAngle[track] ) continue;
+      tensorWriter->BeginSample();
+      for (std::size_t i = 0; i < fTrackIndex.size(); ++i) {
+        if ( fTrackIndex[i] != G4int(track) ) continue;
+        if ( ! tensorWriter->AddStep(pos_x_vector[i], pos_z_vector[i]) ) break;
+      }
+      tensorWriter->EndSample(fTrackInitAngle[track]);
+    }
+  }
+  fTraceRecorder->EndOutputWrite();
+
+  fPerfCounters->EndEvent(event->GetEventID());
+  fMemoryReport->EndOfEvent(event, GetVectorBytes());
 
   //
   // Print diagnostics
@@ -273,6 +393,7 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
     auto hc = GetHC(event, fHodHCID[iDet]);
     if ( ! hc ) return;
     G4cout << "Hodoscope " << iDet + 1 << " has " << hc->GetSize()  << " hits." << G4endl;
+    if ( ! B5Log::IsEnabled(B5Log::kDebug) ) continue;
     for (unsigned int i = 0; i<hc->GetSize(); ++i) {
       hc->GetHit(i)->Print();
     }
@@ -284,6 +405,7 @@ void B5EventAction::EndOfEventAction(const G4Event* event)
     auto hc = GetHC(event, fDriftHCID[iDet]);
     if ( ! hc ) return;
     G4cout << "Drift Chamber " << iDet + 1 << " has " <<  hc->GetSize()  << " hits." << G4endl;
+    if ( ! B5Log::IsEnabled(B5Log::kDebug) ) continue;
     for (auto layer = 0; layer < kNofChambers; ++layer) {
       for (unsigned int i = 0; i < hc->GetSize(); i++) {
         auto hit = static_cast<B5DriftChamberHit*>(hc->GetHit(i));
@@ -0,0 +1,118 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FastShowerSetup.cc
+/// \brief Implementation of the B5FastShowerSetup class
+
+#include "B5FastShowerSetup.hh"
+
+#include "GFlashShowerModel.hh"
+#include "GFlashHomoShowerParameterisation.hh"
+#include "GFlashParticleBounds.hh"
+#include "GFlashHitMaker.hh"
+
+#include "G4Region.hh"
+#include "G4Material.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5FastShowerSetup::fgPhysicsRegistered = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FastShowerSetup::B5FastShowerSetup(G4Region* region, G4Material* material)
+: fMessenger(nullptr), 
+  fShowerModel(nullptr), fParameterisation(nullptr), 
+  fParticleBounds(nullptr), fHitMaker(nullptr),
+  fEmCalOn(false)
+{
+  // the model registers itself with the region
+  fShowerModel = new GFlashShowerModel("B5EmCalShowerModel", region);
+  fParameterisation = new GFlashHomoShowerParameterisation(material);
+  fShowerModel->SetParameterisation(*fParameterisation);
+  fParticleBounds = new GFlashParticleBounds();
+  fShowerModel->SetParticleBounds(*fParticleBounds);
+  fHitMaker = new GFlashHitMaker();
+  fShowerModel->SetHitMaker(*fHitMaker);
+  fShowerModel->SetFlagParamType(0);
+
+  // define commands for this class
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FastShowerSetup::~B5FastShowerSetup()
+{
+  delete fMessenger;
+  delete fShowerModel;
+  delete fParameterisation;
+  delete fParticleBounds;
+  delete fHitMaker;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FastShowerSetup::SetEmCal(const G4String& val)
+{
+  if ( val == "on" && ! fgPhysicsRegistered ) {
+    // warn once, from master
+    if ( ! G4Threading::IsWorkerThread() ) {
+      G4ExceptionDescription msg;
+      msg << "The fast simulation process is not registered, start the job "
+          << "with --fastsim." << G4endl
+          << "The EM calorimeter showers are fully simulated.";
+      G4Exception("B5FastShowerSetup::SetEmCal()",
+                  "B5Code011", JustWarning, msg);
+    }
+    return;
+  }
+
+  fEmCalOn = ( val == "on" );
+  fShowerModel->SetFlagParamType(fEmCalOn ? 1 : 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FastShowerSetup::DefineCommands()
+{
+  // Define /B5/fastsim command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/fastsim/", 
+                                      "Fast simulation control");
+
+  // emcal command
+  auto& emCalCmd
+    = fMessenger->DeclareMethod("emcal", &B5FastShowerSetup::SetEmCal, 
+        "Parameterise the showers in the EM calorimeter (GFlash).");
+  emCalCmd.SetParameterName("flag", true);
+  emCalCmd.SetCandidates("on off");
+  emCalCmd.SetDefaultValue("on");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
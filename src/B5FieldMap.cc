@@ -0,0 +1,241 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FieldMap.cc
+/// \brief Implementation of the B5FieldMap class
+
+#include "B5FieldMap.hh"
+#include "B5ByteOrder.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define B5_FIELDMAP_MMAP 1
+#endif
+
+namespace {
+
+// maps already loaded, shared by all threads
+std::mutex gFieldMapMutex;
+std::map<G4String, std::weak_ptr<const B5FieldMap>> gFieldMaps;
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::shared_ptr<const B5FieldMap> B5FieldMap::Load(const G4String& fileName)
+{
+  std::lock_guard<std::mutex> lock(gFieldMapMutex);
+
+  auto fieldMap = gFieldMaps[fileName].lock();
+  if (fieldMap) return fieldMap;
+
+  std::shared_ptr<const B5FieldMap> newMap(new B5FieldMap(fileName));
+  if (!newMap->fNodes) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read field map " << fileName 
+        << ", the uniform field is kept." << G4endl;
+    G4Exception("B5FieldMap::Load()",
+                "B5Code004", JustWarning, msg);
+    return nullptr;
+  }
+
+  G4cout << "Field map " << fileName << " loaded: " 
+         << newMap->fNx << " x " << newMap->fNy << " x " << newMap->fNz 
+         << " nodes" << G4endl;
+  gFieldMaps[fileName] = newMap;
+  return newMap;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FieldMap::B5FieldMap(const G4String& fileName)
+: fFileName(fileName), fNx(0), fNy(0), fNz(0),
+  fMin(), fStep(), fInvStep(), fNodes(nullptr),
+  fMapping(nullptr), fMappingSize(0), fBuffer()
+{
+  const unsigned char* data = nullptr;
+  std::size_t size = 0;
+
+#ifdef B5_FIELDMAP_MMAP
+  auto fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat status;
+  if (fstat(fd, &status) == 0 && status.st_size > 0) {
+    auto mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      fMapping = mapping;
+      fMappingSize = status.st_size;
+      data = static_cast<const unsigned char*>(mapping);
+      size = fMappingSize;
+    }
+  }
+  close(fd);
+#else
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  if (!file) return;
+  size = file.tellg();
+  fBuffer.resize((size + sizeof(float) - 1)/sizeof(float));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(fBuffer.data()), size);
+  data = reinterpret_cast<const unsigned char*>(fBuffer.data());
+#endif
+
+  if (!data || size < kHeaderSize) return;
+
+  // header, decoded independently of the host byte order
+  auto version = B5GetUInt32(data + 4);
+  G4int n[3];
+  for (G4int i = 0; i < 3; ++i) {
+    n[i] = B5GetInt32(data + 8 + 4*i);
+    fMin[i] = B5GetDouble(data + 24 + 8*i);
+    fStep[i] = B5GetDouble(data + 48 + 8*i);
+  }
+  if (std::memcmp(data, "B5FM", 4) != 0 || version != 1) return;
+  if (n[0] < 2 || n[1] < 2 || n[2] < 2) return;
+  if (!(fStep[0] > 0. && fStep[1] > 0. && fStep[2] > 0.)) return;
+
+  fNx = n[0];
+  fNy = n[1];
+  fNz = n[2];
+  std::size_t nofNodes = std::size_t(fNx) * fNy * fNz;
+  if (size < kHeaderSize + 3*sizeof(float)*nofNodes) return;
+
+  for (G4int i = 0; i < 3; ++i) {
+    fInvStep[i] = 1./fStep[i];
+  }
+  if (B5IsLittleEndianHost()) {
+    // the nodes are used in place
+    fNodes = reinterpret_cast<const float*>(data + kHeaderSize);
+    return;
+  }
+
+  // decode the nodes into the buffer and release the file
+  std::vector<float> nodes(3*nofNodes);
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    nodes[i] = B5GetFloat(data + kHeaderSize + sizeof(float)*i);
+  }
+#ifdef B5_FIELDMAP_MMAP
+  munmap(fMapping, fMappingSize);
+  fMapping = nullptr;
+  fMappingSize = 0;
+#endif
+  fBuffer.swap(nodes);
+  fNodes = fBuffer.data();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FieldMap::~B5FieldMap()
+{
+#ifdef B5_FIELDMAP_MMAP
+  if (fMapping) munmap(fMapping, fMappingSize);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5FieldMap::LocateCell(const G4double point[3], Cache& cache) const
+{
+  G4int index[3];
+  const G4int n[3] = { fNx, fNy, fNz };
+  for (G4int i = 0; i < 3; ++i) {
+    auto u = (point[i] - fMin[i]) * fInvStep[i];
+    if (!(u >= 0.)) {
+      cache.fValid = false;
+      return false;
+    }
+    index[i] = static_cast<G4int>(u);
+    if (index[i] >= n[i] - 1) {
+      cache.fValid = false;
+      return false;
+    }
+  }
+
+  for (G4int corner = 0; corner < 8; ++corner) {
+    auto node = GetNode(index[0] + (corner & 1), 
+                        index[1] + ((corner >> 1) & 1), 
+                        index[2] + ((corner >> 2) & 1));
+    cache.fCorner[corner][0] = node[0];
+    cache.fCorner[corner][1] = node[1];
+    cache.fCorner[corner][2] = node[2];
+  }
+  cache.fX0 = fMin[0] + index[0] * fStep[0];
+  cache.fY0 = fMin[1] + index[1] * fStep[1];
+  cache.fZ0 = fMin[2] + index[2] * fStep[2];
+  cache.fValid = true;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldMap::GetFieldValue(const G4double point[3], G4double* bField,
+                               Cache& cache) const
+{
+  // fractional position in the cached cell
+  auto fx = (point[0] - cache.fX0) * fInvStep[0];
+  auto fy = (point[1] - cache.fY0) * fInvStep[1];
+  auto fz = (point[2] - cache.fZ0) * fInvStep[2];
+
+  if (!cache.fValid || 
+      !(fx >= 0. && fx < 1. && fy >= 0. && fy < 1. && fz >= 0. && fz < 1.)) {
+    if (!LocateCell(point, cache)) {
+      // outside the map
+      bField[0] = 0.;
+      bField[1] = 0.;
+      bField[2] = 0.;
+      return;
+    }
+    fx = (point[0] - cache.fX0) * fInvStep[0];
+    fy = (point[1] - cache.fY0) * fInvStep[1];
+    fz = (point[2] - cache.fZ0) * fInvStep[2];
+  }
+
+  // trilinear interpolation
+  const auto& c = cache.fCorner;
+  for (G4int k = 0; k < 3; ++k) {
+    auto c00 = c[0][k] + fx * (c[1][k] - c[0][k]);
+    auto c10 = c[2][k] + fx * (c[3][k] - c[2][k]);
+    auto c01 = c[4][k] + fx * (c[5][k] - c[4][k]);
+    auto c11 = c[6][k] + fx * (c[7][k] - c[6][k]);
+    auto c0 = c00 + fy * (c10 - c00);
+    auto c1 = c01 + fy * (c11 - c01);
+    bField[k] = (c0 + fz * (c1 - c0)) * tesla;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
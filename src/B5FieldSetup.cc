@@ -0,0 +1,244 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FieldSetup.cc
+/// \brief Implementation of the B5FieldSetup class
+
+#include "B5FieldSetup.hh"
+#include "B5MagneticField.hh"
+#include "B5Log.hh"
+
+#include "G4FieldManager.hh"
+#include "G4ChordFinder.hh"
+#include "G4MagIntegratorDriver.hh"
+#include "G4Mag_UsualEqRhs.hh"
+#include "G4ExactHelixStepper.hh"
+#include "G4ClassicalRK4.hh"
+#include "G4CashKarpRKF45.hh"
+#include "G4DormandPrince745.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+G4ThreadLocal B5FieldSetup* B5FieldSetup::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FieldSetup::B5FieldSetup(B5MagneticField* field)
+: fMessenger(nullptr), fField(field), 
+  fFieldManager(nullptr), fEquation(nullptr), 
+  fStepper(nullptr), fChordFinder(nullptr),
+  fStepperType("auto"), fBuiltStepper(),
+  fMinStep(0.01*mm), fDeltaChord(0.25*mm), fDeltaOneStep(0.01*mm),
+  fMinEpsilon(5.0e-5), fMaxEpsilon(1.0e-3)
+{
+  fgInstance = this;
+
+  fFieldManager = new G4FieldManager();
+  fFieldManager->SetDetectorField(fField);
+  fEquation = new G4Mag_UsualEqRhs(fField);
+
+  BuildChordFinder();
+  ApplyAccuracy();
+
+  // define commands for this class
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5FieldSetup::~B5FieldSetup()
+{
+  delete fMessenger;
+  fFieldManager->SetChordFinder(nullptr);
+  delete fChordFinder;   // deletes the driver
+  delete fStepper;
+  delete fEquation;
+  delete fFieldManager;
+
+  if ( fgInstance == this ) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::Update()
+{
+  // The field mode (uniform or map) may have changed since the chord
+  // finder was built
+  if ( SelectStepper() != fBuiltStepper ) BuildChordFinder();
+  ApplyAccuracy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B5FieldSetup::SelectStepper() const
+{
+  // The exact helix is valid only in a uniform field
+  if ( fStepperType == "auto" ) {
+    return fField->IsMapped() ? "dormandPrince745" : "exactHelix";
+  }
+  if ( fStepperType == "exactHelix" && fField->IsMapped() ) {
+    return "dormandPrince745";
+  }
+  return fStepperType;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::BuildChordFinder()
+{
+  auto stepperType = SelectStepper();
+
+  G4MagIntegratorStepper* stepper = nullptr;
+  if ( stepperType == "exactHelix" ) {
+    stepper = new G4ExactHelixStepper(fEquation);
+  }
+  else if ( stepperType == "classicalRK4" ) {
+    stepper = new G4ClassicalRK4(fEquation);
+  }
+  else if ( stepperType == "cashKarpRKF45" ) {
+    stepper = new G4CashKarpRKF45(fEquation);
+  }
+  else {
+    stepper = new G4DormandPrince745(fEquation);
+  }
+
+  auto driver 
+    = new G4MagInt_Driver(fMinStep, stepper, 
+                          stepper->GetNumberOfVariables());
+  auto chordFinder = new G4ChordFinder(driver);
+  fFieldManager->SetChordFinder(chordFinder);
+
+  delete fChordFinder;   // deletes the driver
+  delete fStepper;
+  fChordFinder = chordFinder;
+  fStepper = stepper;
+  fBuiltStepper = stepperType;
+
+  if ( fStepperType != "auto" && stepperType != fStepperType ) {
+    B5_INFO("B5FieldSetup: %s stepper not valid with a field map, using %s",
+            fStepperType.c_str(), stepperType.c_str());
+  }
+  B5_DEBUG("B5FieldSetup: using %s stepper", stepperType.c_str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::ApplyAccuracy()
+{
+  fChordFinder->SetDeltaChord(fDeltaChord);
+  fFieldManager->SetDeltaOneStep(fDeltaOneStep);
+  fFieldManager->SetMinimumEpsilonStep(fMinEpsilon);
+  fFieldManager->SetMaximumEpsilonStep(fMaxEpsilon);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::SetStepperType(const G4String& val)
+{
+  fStepperType = val;
+  if ( SelectStepper() != fBuiltStepper ) BuildChordFinder();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::SetDeltaChord(G4double val)
+{
+  fDeltaChord = val;
+  ApplyAccuracy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::SetDeltaOneStep(G4double val)
+{
+  fDeltaOneStep = val;
+  ApplyAccuracy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::SetMinEpsilon(G4double val)
+{
+  fMinEpsilon = val;
+  ApplyAccuracy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::SetMaxEpsilon(G4double val)
+{
+  fMaxEpsilon = val;
+  ApplyAccuracy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FieldSetup::DefineCommands()
+{
+  // Define /B5/field command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/field/", 
+                                      "Field control");
+
+  // stepper command
+  auto& stepperCmd
+    = fMessenger->DeclareMethod("stepper", &B5FieldSetup::SetStepperType, 
+        "Select the stepper (auto: exact helix in uniform field, "
+        "Dormand-Prince with a field map).");
+  stepperCmd.SetParameterName("stepper", true);
+  stepperCmd.SetCandidates(
+    "auto exactHelix classicalRK4 cashKarpRKF45 dormandPrince745");
+  stepperCmd.SetDefaultValue("auto");
+
+  // accuracy commands
+  auto& deltaChordCmd
+    = fMessenger->DeclareMethodWithUnit("deltaChord", "mm",
+                                &B5FieldSetup::SetDeltaChord, 
+                                "Set the maximum miss distance of chords.");
+  deltaChordCmd.SetParameterName("deltaChord", false);
+  deltaChordCmd.SetRange("deltaChord>0.");
+
+  auto& deltaOneStepCmd
+    = fMessenger->DeclareMethodWithUnit("deltaOneStep", "mm",
+                                &B5FieldSetup::SetDeltaOneStep, 
+                                "Set the position accuracy of a step.");
+  deltaOneStepCmd.SetParameterName("deltaOneStep", false);
+  deltaOneStepCmd.SetRange("deltaOneStep>0.");
+
+  auto& minEpsilonCmd
+    = fMessenger->DeclareMethod("minEpsilon", &B5FieldSetup::SetMinEpsilon, 
+                                "Set the minimum relative step accuracy.");
+  minEpsilonCmd.SetParameterName("minEpsilon", false);
+  minEpsilonCmd.SetRange("minEpsilon>0.");
+
+  auto& maxEpsilonCmd
+    = fMessenger->DeclareMethod("maxEpsilon", &B5FieldSetup::SetMaxEpsilon, 
+                                "Set the maximum relative step accuracy.");
+  maxEpsilonCmd.SetParameterName("maxEpsilon", false);
+  maxEpsilonCmd.SetRange("maxEpsilon>0.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
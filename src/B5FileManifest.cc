@@ -0,0 +1,126 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5FileManifest.cc
+/// \brief Implementation of the B5FileManifest class
+
+#include "B5FileManifest.hh"
+
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define B5_FILEMANIFEST_CHMOD 1
+#endif
+
+std::mutex B5FileManifest::fgMutex;
+std::vector<G4String> B5FileManifest::fgFiles;
+std::atomic<G4int> B5FileManifest::fgCompression(-1);
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B5FileManifest::GetBaseName(const G4String& fileName)
+{
+  G4String extension = ".root";
+  if ( fileName.size() > extension.size() &&
+       fileName.compare(fileName.size() - extension.size(), 
+                        extension.size(), extension) == 0 ) {
+    return fileName.substr(0, fileName.size() - extension.size());
+  }
+  return fileName;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B5FileManifest::GetWorkerFileName(const G4String& fileName, 
+                                           G4int threadID)
+{
+  // the naming of the Geant4 analysis file manager
+  return GetBaseName(fileName) + "_t" + std::to_string(threadID) + ".root";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FileManifest::Register(const G4String& fileName)
+{
+  std::lock_guard<std::mutex> lock(fgMutex);
+  fgFiles.push_back(fileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5FileManifest::Write(const G4String& masterFileName, G4int runID)
+{
+  std::lock_guard<std::mutex> lock(fgMutex);
+  auto compression = fgCompression.load();
+  if ( fgFiles.empty() && compression < 0 ) return;
+
+  std::sort(fgFiles.begin(), fgFiles.end());
+
+  auto baseName = GetBaseName(masterFileName);
+  auto rootFileName = baseName + ".root";
+
+  auto manifestName = baseName + ".manifest";
+  std::ofstream manifest(manifestName);
+  manifest << "# B5 analysis files of run " << runID << std::endl
+           << "# histograms: master file, ntuple B5: all files" << std::endl
+           << rootFileName << std::endl;
+  for (const auto& file : fgFiles) {
+    manifest << file << std::endl;
+  }
+
+  // The merged file replaces the master file, the worker files are kept
+  auto scriptName = baseName + "_merge.sh";
+  std::ofstream script(scriptName);
+  script << "#!/bin/sh" << std::endl
+         << "# Merge the B5 analysis files of run " << runID << std::endl
+         << "# (set B5_MERGE_JOBS to limit the number of hadd processes)" 
+         << std::endl
+         << "set -e" << std::endl
+         << "hadd -f";
+  if ( compression >= 0 ) script << compression;
+  script << " -j \"${B5_MERGE_JOBS:-$(nproc)}\" " 
+         << baseName << "_merged.root " << rootFileName;
+  for (const auto& file : fgFiles) {
+    script << " " << file;
+  }
+  script << std::endl
+         << "mv " << baseName << "_merged.root " << rootFileName << std::endl;
+  script.close();
+#ifdef B5_FILEMANIFEST_CHMOD
+  chmod(scriptName.c_str(), 0755);
+#endif
+
+  G4cout << "Analysis file manifest written to " << manifestName 
+         << ", merge with " << scriptName << G4endl;
+
+  fgFiles.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
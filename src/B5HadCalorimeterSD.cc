@@ -28,8 +28,10 @@
 /// \brief Implementation of the B5HadCalorimeterSD class
 
 #include "B5HadCalorimeterSD.hh"
+#include "B5PerfCounters.hh"
 #include "B5HadCalorimeterHit.hh"
 #include "B5Constants.hh"
+#include "B5Log.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
@@ -42,7 +44,8 @@
 
 B5HadCalorimeterSD::B5HadCalorimeterSD(G4String name)
 : G4VSensitiveDetector(name), 
-  fHitsCollection(nullptr), fHCID(-1)
+  fHitsCollection(nullptr), fHCID(-1), fCellStore(),
+  fPerfCounters(B5PerfCounters::Instance())
 {
   collectionName.insert("HadCalorimeterColl");
 }
@@ -63,18 +66,16 @@ void B5HadCalorimeterSD::Initialize(G4HCofThisEvent* hce)
   }
   hce->AddHitsCollection(fHCID,fHitsCollection);
   
-  // fill calorimeter hits with zero energy deposition
-  for (auto column=0;column<kNofHadColumns;column++) {
-    for (auto row=0;row<kNofHadRows;row++) {
-      fHitsCollection->insert(new B5HadCalorimeterHit());
-    }
-  }
+  // reset the cells touched in the previous event
+  fCellStore.Reset();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4bool B5HadCalorimeterSD::ProcessHits(G4Step* step, G4TouchableHistory*)
 {
+  B5PerfCounters::SDScope perfScope(fPerfCounters);
+
   auto edep = step->GetTotalEnergyDeposit();
   if (edep==0.) return true;
   
@@ -82,22 +83,38 @@ G4bool B5HadCalorimeterSD::ProcessHits(G4Step* step, G4TouchableHistory*)
   auto rowNo = touchable->GetCopyNumber(2);
   auto columnNo = touchable->GetCopyNumber(3);
   auto hitID = kNofHadRows*columnNo+rowNo;
-  auto hit = (*fHitsCollection)[hitID];
+  G4bool isFirst;
+  auto& cell = fCellStore.Touch(hitID, isFirst);
   
   // check if it is first touch
-  if (hit->GetColumnID()<0) {
-    hit->SetColumnID(columnNo);
-    hit->SetRowID(rowNo);
+  if (isFirst) {
     auto depth = touchable->GetHistory()->GetDepth();
     auto transform = touchable->GetHistory()->GetTransform(depth-2);
     transform.Invert();
-    hit->SetRot(transform.NetRotation());
-    hit->SetPos(transform.NetTranslation());
+    cell.fRot = transform.NetRotation();
+    cell.fPos = transform.NetTranslation();
   }
   // add energy deposition
-  hit->AddEdep(edep);
+  cell.fEdep += edep;
   
   return true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HadCalorimeterSD::EndOfEvent(G4HCofThisEvent*)
+{
+  // export the touched cells only
+  for (auto hitID : fCellStore.GetDirtyCells()) {
+    const auto& cell = fCellStore.GetCell(hitID);
+    auto hit = new B5HadCalorimeterHit(hitID/kNofHadRows, hitID%kNofHadRows);
+    hit->SetEdep(cell.fEdep);
+    hit->SetRot(cell.fRot);
+    hit->SetPos(cell.fPos);
+    fHitsCollection->insert(hit);
+  }
+  B5_DEBUG("%s: %zu touched cells", GetName().c_str(), 
+           fCellStore.GetDirtyCells().size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
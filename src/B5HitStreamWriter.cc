@@ -0,0 +1,288 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5HitStreamWriter.cc
+/// \brief Implementation of the B5HitStreamWriter class
+
+#include "B5HitStreamWriter.hh"
+#include "B5ByteOrder.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5HitStreamWriter* B5HitStreamWriter::fgInstance = nullptr;
+std::mutex B5HitStreamWriter::fgShardMutex;
+std::vector<std::pair<G4String, G4long>> B5HitStreamWriter::fgShards;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HitStreamWriter* B5HitStreamWriter::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5HitStreamWriter();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HitStreamWriter::B5HitStreamWriter()
+: fMessenger(nullptr), fPrefix(), fBufferSizeMB(16),
+  fFile(nullptr), fFileName(), fNofRecords(0), fWriteError(false),
+  fBuffer(), fBufferUsed(0), fFlushBuffer(), fFlushSize(0),
+  fFlushThread(), fMutex(), fCondition(), 
+  fFlushPending(false), fStop(false)
+{
+  // define commands for this class
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HitStreamWriter::~B5HitStreamWriter()
+{
+  Close();
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::SetPrefix(const G4String& val)
+{
+  fPrefix = (val == "none") ? G4String() : val;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::Open(G4int runID)
+{
+  if (!IsEnabled() || IsOpen()) return;
+
+  auto threadID = G4Threading::G4GetThreadId();
+  std::ostringstream fileName;
+  fileName << fPrefix << "_r" << runID << "_t" << (threadID < 0 ? 0 : threadID) 
+           << ".bin";
+  fFileName = fileName.str();
+
+  fFile = std::fopen(fFileName.c_str(), "wb");
+  if (!fFile) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open hit stream file " << fFileName << G4endl;
+    G4Exception("B5HitStreamWriter::Open()",
+                "B5Code003", JustWarning, msg);
+    return;
+  }
+
+  // header
+  unsigned char header[12];
+  std::memcpy(header, "B5HS", 4);
+  B5PutUInt32(header + 4, 1);
+  B5PutUInt32(header + 8, kRecordSize);
+  fWriteError = ( std::fwrite(header, 1, sizeof(header), fFile) 
+                  != sizeof(header) );
+
+  auto bufferSize = static_cast<std::size_t>(fBufferSizeMB) << 20;
+  fBuffer.resize(bufferSize);
+  fFlushBuffer.resize(bufferSize);
+  fBufferUsed = 0;
+  fFlushSize = 0;
+  fNofRecords = 0;
+  fFlushPending = false;
+  fStop = false;
+  fFlushThread = std::thread(&B5HitStreamWriter::FlushLoop, this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::Close()
+{
+  if (!IsOpen()) return;
+
+  // write the partially filled buffer and stop the flush thread
+  Submit();
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fCondition.notify_all();
+  fFlushThread.join();
+
+  if ( std::fclose(fFile) != 0 ) fWriteError = true;
+  fFile = nullptr;
+
+  // After a failed write (e.g. a full disk) the shard is truncated: 
+  // only the complete records found in the file are listed
+  auto nofRecords = fNofRecords;
+  if ( fWriteError ) {
+    std::ifstream shard(fFileName, std::ios::binary | std::ios::ate);
+    std::streamoff size = shard ? std::streamoff(shard.tellg()) : 0;
+    nofRecords = size > 12 ? (size - 12) / kRecordSize : 0;
+    G4ExceptionDescription msg;
+    msg << "Writing hit stream file " << fFileName << " failed: " 
+        << nofRecords << " of " << fNofRecords << " records written.";
+    G4Exception("B5HitStreamWriter::Close()",
+                "B5Code003", JustWarning, msg);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(fgShardMutex);
+    fgShards.emplace_back(fFileName, nofRecords);
+  }
+
+  // release the buffers
+  std::vector<unsigned char>().swap(fBuffer);
+  std::vector<unsigned char>().swap(fFlushBuffer);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::Write(G4int eventID, G4int layerID, 
+                              const G4ThreeVector& pos,
+                              G4double time, G4double momentum)
+{
+  if (!IsOpen()) return;
+
+  if (fBufferUsed + kRecordSize > fBuffer.size()) Submit();
+
+  auto record = fBuffer.data() + fBufferUsed;
+  B5PutInt32(record, eventID);
+  B5PutInt32(record + 4, layerID);
+  B5PutFloat(record + 8, pos.x()/mm);
+  B5PutFloat(record + 12, pos.y()/mm);
+  B5PutFloat(record + 16, pos.z()/mm);
+  B5PutFloat(record + 20, time/ns);
+  B5PutFloat(record + 24, momentum);
+  fBufferUsed += kRecordSize;
+  ++fNofRecords;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::Submit()
+{
+  // wait for the previous buffer to be written, then swap the buffers
+  std::unique_lock<std::mutex> lock(fMutex);
+  fCondition.wait(lock, [this] { return ! fFlushPending; });
+  std::swap(fBuffer, fFlushBuffer);
+  fFlushSize = fBufferUsed;
+  fBufferUsed = 0;
+  fFlushPending = true;
+  lock.unlock();
+  fCondition.notify_all();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::FlushLoop()
+{
+  std::unique_lock<std::mutex> lock(fMutex);
+  while (true) {
+    fCondition.wait(lock, [this] { return fFlushPending || fStop; });
+    if (fFlushPending) {
+      lock.unlock();
+      // nothing more is written after a failure, so that the shard 
+      // holds the records up to the failure only
+      if ( ! fWriteError &&
+           std::fwrite(fFlushBuffer.data(), 1, fFlushSize, fFile) 
+             != fFlushSize ) {
+        fWriteError = true;
+      }
+      lock.lock();
+      fFlushPending = false;
+      fCondition.notify_all();
+    }
+    else if (fStop) {
+      break;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::WriteManifest(G4int runID)
+{
+  std::lock_guard<std::mutex> lock(fgShardMutex);
+  if (fgShards.empty()) return;
+
+  std::ostringstream fileName;
+  fileName << Instance()->GetPrefix() << "_r" << runID << ".manifest";
+  std::ofstream manifest(fileName.str());
+  manifest << "# B5 hit stream manifest" << std::endl
+           << "format B5HS 1" << std::endl
+           << "record " << kRecordSize << std::endl;
+  for (const auto& shard : fgShards) {
+    manifest << "shard " << shard.first << " " << shard.second << std::endl;
+  }
+  fgShards.clear();
+  manifest.close();
+
+  if ( ! manifest ) {
+    G4ExceptionDescription msg;
+    msg << "Writing hit stream manifest " << fileName.str() << " failed.";
+    G4Exception("B5HitStreamWriter::WriteManifest()",
+                "B5Code003", JustWarning, msg);
+    return;
+  }
+
+  G4cout << "Hit stream manifest written to " << fileName.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HitStreamWriter::DefineCommands()
+{
+  // Define /B5/output command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/output/", 
+                                      "Output control");
+
+  // hitStream command
+  auto& streamCmd
+    = fMessenger->DeclareMethod("hitStream", &B5HitStreamWriter::SetPrefix,
+        "Write the drift chamber hits to per-thread binary shards\n"
+        "<prefix>_r<run>_t<thread>.bin; \"none\" switches it off.");
+  streamCmd.SetParameterName("prefix", true);
+  streamCmd.SetDefaultValue("none");
+
+  // hitStreamBuffer command
+  auto& bufferCmd
+    = fMessenger->DeclareProperty("hitStreamBuffer", fBufferSizeMB,
+        "Size of each of the two hit stream buffers per thread, in MB.");
+  bufferCmd.SetParameterName("size", true);
+  bufferCmd.SetRange("size>0");
+  bufferCmd.SetDefaultValue("16");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
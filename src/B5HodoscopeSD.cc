@@ -28,7 +28,9 @@
 /// \brief Implementation of the B5HodoscopeSD class
 
 #include "B5HodoscopeSD.hh"
+#include "B5PerfCounters.hh"
 #include "B5HodoscopeHit.hh"
+#include "B5Log.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
@@ -41,9 +43,12 @@
 
 B5HodoscopeSD::B5HodoscopeSD(G4String name)
 : G4VSensitiveDetector(name), 
-  fHitsCollection(nullptr), fHCID(-1)
+  fHitsCollection(nullptr), fHCID(-1),
+  fHitIndex(), fNofLookups(0), fNofLookupsTotal(0),
+  fPerfCounters(B5PerfCounters::Instance())
 {
   collectionName.insert( "hodoscopeColl");
+  fHitIndex.fill(-1);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -61,12 +66,18 @@ void B5HodoscopeSD::Initialize(G4HCofThisEvent* hce)
     fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection); 
   }
   hce->AddHitsCollection(fHCID,fHitsCollection);
+
+  // reset the strip index for the new event
+  fHitIndex.fill(-1);
+  fNofLookups = 0;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4bool B5HodoscopeSD::ProcessHits(G4Step* step, G4TouchableHistory*)
 {
+  B5PerfCounters::SDScope perfScope(fPerfCounters);
+
   auto edep = step->GetTotalEnergyDeposit();
   if (edep==0.) return true;
   
@@ -75,19 +86,23 @@ G4bool B5HodoscopeSD::ProcessHits(G4Step* step, G4TouchableHistory*)
   auto copyNo = touchable->GetVolume()->GetCopyNo();
   auto hitTime = preStepPoint->GetGlobalTime();
   
-  // check if this finger already has a hit
-  auto ix = -1;
-  for (std::size_t i=0;i<fHitsCollection->entries();++i) {
-    if ((*fHitsCollection)[i]->GetID()==copyNo) {
-      ix = i;
-      break;
-    }
+  if (copyNo<0 || copyNo>=kNofHodoscopesMax) {
+    G4ExceptionDescription msg;
+    msg << "Strip copy number " << copyNo << " out of range." << G4endl;
+    G4Exception("B5HodoscopeSD::ProcessHits()",
+                "B5Code002", JustWarning, msg);
+    return true;
   }
 
+  // check if this finger already has a hit
+  ++fNofLookups;
+  auto ix = fHitIndex[copyNo];
+
   if (ix>=0) {
     // if it has, then take the earlier time
-    if ((*fHitsCollection)[ix]->GetTime()>hitTime) { 
-      (*fHitsCollection)[ix]->SetTime(hitTime); 
+    auto hit = (*fHitsCollection)[ix];
+    if (hit->GetTime()>hitTime) { 
+      hit->SetTime(hitTime); 
     }
   }
   else {
@@ -99,9 +114,20 @@ G4bool B5HodoscopeSD::ProcessHits(G4Step* step, G4TouchableHistory*)
     transform.Invert();
     hit->SetRot(transform.NetRotation());
     hit->SetPos(transform.NetTranslation());
-    fHitsCollection->insert(hit);
+    fHitIndex[copyNo] = fHitsCollection->insert(hit) - 1;
   }    
   return true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HodoscopeSD::EndOfEvent(G4HCofThisEvent*)
+{
+  fNofLookupsTotal += fNofLookups;
+
+  B5_DEBUG("%s: %ld hit lookups for %zu hits in this event, %ld in total",
+           GetName().c_str(), fNofLookups, fHitsCollection->entries(), 
+           fNofLookupsTotal);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
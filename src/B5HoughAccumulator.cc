@@ -0,0 +1,258 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5HoughAccumulator.cc
+/// \brief Implementation of the B5HoughAccumulator class
+
+#include "B5HoughAccumulator.hh"
+
+#include "G4GenericMessenger.hh"
+#include "g4analysis.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Bin index with the underflow bin 0 and the overflow bin nbins+1,
+// or -1 if the value is not a number
+inline G4int FindBin(G4double value, G4int nbins, G4double min, G4double max)
+{
+  if (std::isnan(value)) return -1;
+  if (value < min) return 0;
+  if (value >= max) return nbins + 1;
+  auto bin = 1 + static_cast<G4int>((value - min) / (max - min) * nbins);
+  return bin > nbins ? nbins : bin;
+}
+
+// Bin index as used by the tools histograms: the in-range bins from 0, 
+// the underflow bin -2 and the overflow bin -1
+inline G4int ToolsBin(G4int bin, G4int nbins)
+{
+  if (bin == 0) return -2;
+  if (bin == nbins + 1) return -1;
+  return bin - 1;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5HoughAccumulator* B5HoughAccumulator::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HoughAccumulator* B5HoughAccumulator::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5HoughAccumulator();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HoughAccumulator::Bins::Bins(std::size_t size, G4bool hasY)
+: fEntries(size, 0.), fSumX(size, 0.), fSumX2(size, 0.),
+  fSumY(hasY ? size : 0, 0.), fSumY2(hasY ? size : 0, 0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HoughAccumulator::Bins::Reset()
+{
+  std::fill(fEntries.begin(), fEntries.end(), 0.);
+  std::fill(fSumX.begin(), fSumX.end(), 0.);
+  std::fill(fSumX2.begin(), fSumX2.end(), 0.);
+  std::fill(fSumY.begin(), fSumY.end(), 0.);
+  std::fill(fSumY2.begin(), fSumY2.end(), 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HoughAccumulator::B5HoughAccumulator()
+: fMessenger(nullptr), fEnabled(true),
+  fHistAId(-1), fHistBId(-1), fHistABId(-1),
+  fBinsA(kNofHoughABins+2, false),
+  fBinsB(kNofHoughBBins+2, false),
+  fBinsAB((kNofHoughABins+2)*(kNofHoughBBins+2), true),
+  fAngle(), fIntercept(), fBinA(), fBinB()
+{
+  // the histograms are booked by the run action before
+  auto analysisManager = G4AnalysisManager::Instance();
+  fHistAId = analysisManager->GetH1Id("HistA");
+  fHistBId = analysisManager->GetH1Id("HistB");
+  fHistABId = analysisManager->GetH2Id("HistAB");
+
+  // define commands for this class
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5HoughAccumulator::~B5HoughAccumulator()
+{
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HoughAccumulator::Reset()
+{
+  fBinsA.Reset();
+  fBinsB.Reset();
+  fBinsAB.Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HoughAccumulator::AddEvent(const G4double* x, const G4double* z,
+                                  std::size_t nofHits)
+{
+  if (!fEnabled || nofHits < 2) return;
+
+  fAngle.resize(nofHits);
+  fIntercept.resize(nofHits);
+  fBinA.resize(nofHits);
+  fBinB.resize(nofHits);
+  auto angle = fAngle.data();
+  auto intercept = fIntercept.data();
+  auto binA = fBinA.data();
+  auto binB = fBinB.data();
+
+  for (std::size_t i = 0; i < nofHits - 1; ++i) {
+    const auto xi = x[i];
+    const auto zi = z[i];
+    const auto xj = x + i + 1;
+    const auto zj = z + i + 1;
+    const auto nofPairs = nofHits - i - 1;
+
+    // pair kernel: branch-free over contiguous arrays, so that
+    // the compiler can vectorise it
+#pragma omp simd
+    for (std::size_t k = 0; k < nofPairs; ++k) {
+      auto diffX = xi - xj[k];
+      auto diffZ = zi - zj[k];
+      angle[k] = std::atan2(diffZ, diffX);
+      intercept[k] = zi - (diffZ / diffX) * xi;
+      binA[k] = FindBin(angle[k], kNofHoughABins, kHoughAMin, kHoughAMax);
+      binB[k] = FindBin(intercept[k], kNofHoughBBins, kHoughBMin, kHoughBMax);
+    }
+
+    // accumulation (the bins of the pairs may coincide)
+    for (std::size_t k = 0; k < nofPairs; ++k) {
+      const auto a = angle[k];
+      const auto b = intercept[k];
+      if (binA[k] >= 0) {
+        fBinsA.fEntries[binA[k]] += 1.;
+        fBinsA.fSumX[binA[k]] += a;
+        fBinsA.fSumX2[binA[k]] += a * a;
+      }
+      if (binB[k] >= 0) {
+        fBinsB.fEntries[binB[k]] += 1.;
+        fBinsB.fSumX[binB[k]] += b;
+        fBinsB.fSumX2[binB[k]] += b * b;
+      }
+      if (binA[k] >= 0 && binB[k] >= 0) {
+        auto binAB = binA[k]*(kNofHoughBBins+2) + binB[k];
+        fBinsAB.fEntries[binAB] += 1.;
+        fBinsAB.fSumX[binAB] += a;
+        fBinsAB.fSumX2[binAB] += a * a;
+        fBinsAB.fSumY[binAB] += b;
+        fBinsAB.fSumY2[binAB] += b * b;
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HoughAccumulator::MergeIntoHistograms() const
+{
+  // the bins are added to the bin contents of the histograms, 
+  // which are then written (and merged on master) as if filled per pair
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  auto mergeH1 = [](tools::histo::h1d* h1, const Bins& bins, G4int nbins) {
+    if (!h1) return;
+    for (G4int bin = 0; bin < nbins+2; ++bin) {
+      auto entries = bins.fEntries[bin];
+      if (entries == 0.) continue;
+      auto toolsBin = ToolsBin(bin, nbins);
+      tools::histo::h1d::num_entries_t n = 0;
+      G4double sw = 0., sw2 = 0., sxw = 0., sx2w = 0.;
+      h1->get_bin_content(toolsBin, n, sw, sw2, sxw, sx2w);
+      h1->set_bin_content(toolsBin,
+        n + static_cast<tools::histo::h1d::num_entries_t>(entries),
+        sw + entries, sw2 + entries, 
+        sxw + bins.fSumX[bin], sx2w + bins.fSumX2[bin]);
+    }
+  };
+
+  mergeH1(analysisManager->GetH1(fHistAId), fBinsA, kNofHoughABins);
+  mergeH1(analysisManager->GetH1(fHistBId), fBinsB, kNofHoughBBins);
+
+  auto h2 = analysisManager->GetH2(fHistABId);
+  if (!h2) return;
+  for (G4int binA = 0; binA < kNofHoughABins+2; ++binA) {
+    for (G4int binB = 0; binB < kNofHoughBBins+2; ++binB) {
+      auto bin = binA*(kNofHoughBBins+2) + binB;
+      auto entries = fBinsAB.fEntries[bin];
+      if (entries == 0.) continue;
+      auto toolsBinA = ToolsBin(binA, kNofHoughABins);
+      auto toolsBinB = ToolsBin(binB, kNofHoughBBins);
+      tools::histo::h2d::num_entries_t n = 0;
+      G4double sw = 0., sw2 = 0., sxw = 0., sx2w = 0., syw = 0., sy2w = 0.;
+      h2->get_bin_content(toolsBinA, toolsBinB, n, sw, sw2, 
+                          sxw, sx2w, syw, sy2w);
+      h2->set_bin_content(toolsBinA, toolsBinB,
+        n + static_cast<tools::histo::h2d::num_entries_t>(entries),
+        sw + entries, sw2 + entries,
+        sxw + fBinsAB.fSumX[bin], sx2w + fBinsAB.fSumX2[bin],
+        syw + fBinsAB.fSumY[bin], sy2w + fBinsAB.fSumY2[bin]);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5HoughAccumulator::DefineCommands()
+{
+  // Define /B5/chamber command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/chamber/", 
+                                      "Drift chamber control");
+
+  // pairHistograms command
+  auto& pairCmd
+    = fMessenger->DeclareProperty("pairHistograms", fEnabled,
+        "Accumulate the pairwise hit histograms (HistA, HistB, HistAB).");
+  pairCmd.SetParameterName("flg", true);
+  pairCmd.SetDefaultValue("true");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
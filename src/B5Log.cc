@@ -0,0 +1,142 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5Log.cc
+/// \brief Implementation of the B5Log and B5LogMessenger classes
+
+#include "B5Log.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4ios.hh"
+
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+
+namespace {
+
+const std::array<G4String, B5Log::kOff+1> kLevelName 
+  = {{ "trace", "debug", "info", "warning", "error", "off" }};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::atomic<G4int> B5Log::fgLevel(B5Log::kInfo);
+std::atomic<G4int> B5Log::fgRateLimit(0);
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5Log::Count(G4int& siteCounter)
+{
+  auto limit = fgRateLimit.load(std::memory_order_relaxed);
+  if (limit <= 0) return true;
+
+  if (siteCounter < limit) {
+    ++siteCounter;
+    return true;
+  }
+  if (siteCounter == limit) {
+    ++siteCounter;
+    G4cout << "[B5] rate limit of " << limit 
+           << " messages reached, further messages from this call site"
+           << " are suppressed" << G4endl;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5Log::Print(G4int level, const char* format, ...)
+{
+  std::array<char, 1024> buffer;
+  va_list args;
+  va_start(args, format);
+  std::vsnprintf(buffer.data(), buffer.size(), format, args);
+  va_end(args);
+
+  if (level >= kWarning) {
+    G4cerr << "[" << kLevelName[level] << "] " << buffer.data() << G4endl;
+  }
+  else {
+    G4cout << "[" << kLevelName[level] << "] " << buffer.data() << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5LogMessenger::B5LogMessenger()
+: fMessenger(nullptr)
+{
+  // Define /B5/log command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/log/", 
+                                      "Logging control");
+
+  // level command
+  auto& levelCmd
+    = fMessenger->DeclareMethod("level", &B5LogMessenger::SetLevel, 
+        "Set the minimum level of the printed messages.");
+  levelCmd.SetParameterName("level", true);
+  levelCmd.SetCandidates("trace debug info warning error off");
+  levelCmd.SetDefaultValue("info");
+  // the level is shared by all threads
+  levelCmd.command->SetToBeBroadcasted(false);
+
+  // rateLimit command
+  auto& rateLimitCmd
+    = fMessenger->DeclareMethod("rateLimit", &B5LogMessenger::SetRateLimit, 
+        "Maximum number of messages per call site and thread (0 = no limit).");
+  rateLimitCmd.SetParameterName("n", true);
+  rateLimitCmd.SetRange("n>=0");
+  rateLimitCmd.SetDefaultValue("0");
+  rateLimitCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5LogMessenger::~B5LogMessenger()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5LogMessenger::SetLevel(const G4String& name)
+{
+  for (G4int level = 0; level <= B5Log::kOff; ++level) {
+    if (name == kLevelName[level]) {
+      B5Log::SetLevel(level);
+      if (!B5Log::IsCompiled(level) && level != B5Log::kOff) {
+        G4cout << "[B5] messages of level " << name 
+               << " are compiled out in this build" << G4endl;
+      }
+      return;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
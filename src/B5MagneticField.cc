@@ -37,7 +37,7 @@
 
 B5MagneticField::B5MagneticField()
 : G4MagneticField(), 
-  fMessenger(nullptr), fBy(0.4*tesla)
+  fMessenger(nullptr), fBy(0.4*tesla), fFieldMap(), fMapCache()
 {
   // define commands for this class
   DefineCommands();
@@ -50,8 +50,13 @@ B5MagneticField::~B5MagneticField()
   delete fMessenger; 
 }
 
-void B5MagneticField::GetFieldValue(const G4double [4],double *bField) const
+void B5MagneticField::GetFieldValue(const G4double point[4],double *bField) const
 {
+  if (fFieldMap) {
+    fFieldMap->GetFieldValue(point, bField, fMapCache);
+    return;
+  }
+
   bField[0] = 0.;
   bField[1] = fBy;
   bField[2] = 0.;
@@ -59,6 +64,18 @@ void B5MagneticField::GetFieldValue(const G4double [4],double *bField) const
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B5MagneticField::SetFieldMap(const G4String& fileName)
+{
+  fMapCache = B5FieldMap::Cache();
+  if (fileName == "none") {
+    fFieldMap.reset();
+    return;
+  }
+  fFieldMap = B5FieldMap::Load(fileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void B5MagneticField::DefineCommands()
 {
   // Define /B5/field command directory using generic messenger class
@@ -73,6 +90,13 @@ void B5MagneticField::DefineCommands()
                                 "Set field strength.");
   valueCmd.SetParameterName("field", true);
   valueCmd.SetDefaultValue("1.");
+
+  // map command
+  auto& mapCmd
+    = fMessenger->DeclareMethod("map", &B5MagneticField::SetFieldMap, 
+        "Use the field map from the given file (\"none\" for uniform field).");
+  mapCmd.SetParameterName("file", true);
+  mapCmd.SetDefaultValue("none");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
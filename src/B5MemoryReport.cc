@@ -0,0 +1,234 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5MemoryReport.cc
+/// \brief Implementation of the B5MemoryReport class
+
+#include "B5MemoryReport.hh"
+#include "B5DriftChamberHit.hh"
+#include "B5EmCalorimeterHit.hh"
+#include "B5HadCalorimeterHit.hh"
+#include "B5HodoscopeHit.hh"
+
+#include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4VHitsCollection.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+#include "g4analysis.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+template <class T>
+std::size_t GetPoolSize(const G4Allocator<T>* allocator)
+{
+  return allocator ? allocator->GetAllocatedSize() : 0;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5MemoryReport* B5MemoryReport::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5MemoryReport* B5MemoryReport::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5MemoryReport();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5MemoryReport::B5MemoryReport()
+: fMessenger(nullptr), fEveryNEvents(-1), fNofEvents(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5MemoryReport::~B5MemoryReport()
+{
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::SetReport(G4int nEvents)
+{
+  fEveryNEvents = nEvents < 0 ? -1 : nEvents;
+
+  // the workers report at the start of their next run
+  if (IsEnabled() && !G4Threading::IsWorkerThread()) Report("now");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::BeginOfRun(G4int runID)
+{
+  fNofEvents = 0;
+  if (!IsEnabled()) return;
+
+  Report("run " + std::to_string(runID) + " start");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::EndOfEvent(const G4Event* event, 
+                                std::size_t eventActionBytes)
+{
+  ++fNofEvents;
+  if (fEveryNEvents <= 0 || fNofEvents % fEveryNEvents != 0) return;
+
+  Report("event " + std::to_string(event->GetEventID()), 
+         event->GetHCofThisEvent(), eventActionBytes);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::EndOfRun(G4int runID)
+{
+  if (!IsEnabled()) return;
+
+  Report("run " + std::to_string(runID) + " end");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::GetProcessMemory(G4double& rss, G4double& peak)
+{
+  rss = 0.;
+  peak = 0.;
+#if defined(__linux__)
+  // values in kB
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    G4double value = 0.;
+    fields >> key >> value;
+    if (key == "VmRSS:") rss = value*1024.;
+    if (key == "VmHWM:") peak = value*1024.;
+  }
+#elif defined(__unix__) || defined(__APPLE__)
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+    peak = usage.ru_maxrss;
+#else
+    peak = usage.ru_maxrss*1024.;
+#endif
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::Report(const G4String& when, 
+                            G4HCofThisEvent* hce,
+                            std::size_t eventActionBytes) const
+{
+  const G4double kB = 1024.;
+  const G4double MB = 1024.*1024.;
+
+  G4double rss = 0.;
+  G4double peak = 0.;
+  GetProcessMemory(rss, peak);
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(1) 
+         << "Memory " << when << ": RSS " << rss/MB << " MB, peak " 
+         << peak/MB << " MB; hit pools " 
+         << GetPoolSize(B5DriftChamberHitAllocator)/kB << " + " 
+         << GetPoolSize(B5EmCalorimeterHitAllocator)/kB << " + "
+         << GetPoolSize(B5HadCalorimeterHitAllocator)/kB << " + "
+         << GetPoolSize(B5HodoscopeHitAllocator)/kB 
+         << " kB (drift chamber, EM, Had, hodoscope)";
+
+  // the histograms have a fixed binning: their size only depends on 
+  // the number of bins
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4long nofBins = 0;
+  auto firstH1 = analysisManager->GetFirstH1Id();
+  for (G4int id = firstH1; id < firstH1 + analysisManager->GetNofH1s(); ++id) {
+    if (auto h1 = analysisManager->GetH1(id, false)) nofBins += h1->get_bins();
+  }
+  auto firstH2 = analysisManager->GetFirstH2Id();
+  for (G4int id = firstH2; id < firstH2 + analysisManager->GetNofH2s(); ++id) {
+    if (auto h2 = analysisManager->GetH2(id, false)) nofBins += h2->get_bins();
+  }
+  report << "; " << analysisManager->GetNofH1s() + analysisManager->GetNofH2s()
+         << " histograms, " << nofBins << " bins";
+
+  if (hce) {
+    report << "; hits";
+    for (G4int i = 0; i < hce->GetNumberOfCollections(); ++i) {
+      auto hc = hce->GetHC(i);
+      if (!hc) continue;
+      report << " " << hc->GetSDname() << " " << hc->GetSize();
+    }
+    report << "; event action vectors " << eventActionBytes/kB << " kB";
+  }
+
+  G4cout << report.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5MemoryReport::DefineCommands()
+{
+  // Define /B5/mem command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/mem/", 
+                                      "Memory reports");
+
+  // report command
+  auto& reportCmd
+    = fMessenger->DeclareMethod("report", &B5MemoryReport::SetReport,
+        "Print the memory use now, at the start and the end of each run\n"
+        "and, if nEvents > 0, every nEvents events of each thread;\n"
+        "-1 switches the reports off.");
+  reportCmd.SetParameterName("nEvents", true);
+  reportCmd.SetDefaultValue("0");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,361 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5PerfCounters.cc
+/// \brief Implementation of the B5PerfCounters class
+
+#include "B5PerfCounters.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// warn once, not for each thread
+std::atomic<G4bool> gWarned(false);
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5PerfCounters* B5PerfCounters::fgInstance = nullptr;
+std::mutex B5PerfCounters::fgMutex;
+B5PerfCounters::Values B5PerfCounters::fgEventTotal = {};
+B5PerfCounters::Values B5PerfCounters::fgSDTotal = {};
+G4long B5PerfCounters::fgNofEvents = 0;
+G4long B5PerfCounters::fgNofMultiplexed = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5PerfCounters* B5PerfCounters::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5PerfCounters();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5PerfCounters::B5PerfCounters()
+: fMessenger(nullptr), fPrefix(),
+  fFds(), fGroupFd(-1), fFile(nullptr),
+  fEventBegin(), fSDBegin(), fSDEvent(), fEventTotal(), fSDTotal(),
+  fNofEvents(0), fNofMultiplexed(0)
+{
+  fFds.fill(-1);
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5PerfCounters::~B5PerfCounters()
+{
+  Close();
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::SetPrefix(const G4String& val)
+{
+  fPrefix = (val == "none") ? G4String() : val;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::Open(G4int runID)
+{
+  if (!IsEnabled() || IsOpen()) return;
+
+  G4ExceptionDescription msg;
+#ifdef __linux__
+  const std::uint64_t configs[kNofCounters] = { 
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+  // one group read at once; the leader starts disabled
+  for (G4int i = 0; i < kNofCounters; ++i) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.disabled = (i == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | 
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | 
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread, any CPU
+    fFds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, 
+                      i == 0 ? -1 : fFds[0], 0);
+    if (fFds[i] < 0) {
+      msg << "perf_event_open failed: " << std::strerror(errno) << ".";
+      break;
+    }
+  }
+  if (msg.str().empty()) {
+    fGroupFd = fFds[0];
+    ioctl(fGroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fGroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  } 
+  else {
+    for (auto& fd : fFds) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+  }
+#else
+  msg << "Hardware performance counters are available on Linux only.";
+#endif
+  if (!IsOpen()) {
+    if (!gWarned.exchange(true)) {
+      msg << " The counters are switched off.";
+      G4Exception("B5PerfCounters::Open()",
+                  "B5Code009", JustWarning, msg);
+    }
+    fPrefix = G4String();
+    return;
+  }
+
+  auto threadID = G4Threading::G4GetThreadId();
+  std::ostringstream fileName;
+  fileName << fPrefix << "_r" << runID << "_t" << (threadID < 0 ? 0 : threadID) 
+           << ".csv";
+  fFile = std::fopen(fileName.str().c_str(), "w");
+  if (fFile) {
+    std::fprintf(fFile, "event,cycles,instructions,cacheMisses,branchMisses,"
+                        "sdCycles,sdInstructions,sdCacheMisses,sdBranchMisses,"
+                        "running\n");
+  }
+  fEventTotal.fill(0);
+  fSDTotal.fill(0);
+  fNofEvents = 0;
+  fNofMultiplexed = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::Close()
+{
+  if (!IsOpen()) return;
+
+#ifdef __linux__
+  for (auto& fd : fFds) {
+    close(fd);
+    fd = -1;
+  }
+#endif
+  fGroupFd = -1;
+  if (fFile) {
+    std::fclose(fFile);
+    fFile = nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(fgMutex);
+  for (G4int i = 0; i < kNofCounters; ++i) {
+    fgEventTotal[i] += fEventTotal[i];
+    fgSDTotal[i] += fSDTotal[i];
+  }
+  fgNofEvents += fNofEvents;
+  fgNofMultiplexed += fNofMultiplexed;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::Read(Sample& sample)
+{
+#ifdef __linux__
+  // PERF_FORMAT_GROUP with the total times: number of counters, 
+  // time enabled, time running, then the counter values
+  std::uint64_t buffer[kNofCounters + 3] = {};
+  if (read(fGroupFd, buffer, sizeof(buffer)) == sizeof(buffer)) {
+    sample.fEnabled = buffer[1];
+    sample.fRunning = buffer[2];
+    for (G4int i = 0; i < kNofCounters; ++i) sample.fValues[i] = buffer[i + 3];
+    return;
+  }
+#endif
+  sample.fValues.fill(0);
+  sample.fEnabled = 0;
+  sample.fRunning = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B5PerfCounters::Difference(const Sample& begin, const Sample& end,
+                                    Values& values)
+{
+  auto enabled = end.fEnabled - begin.fEnabled;
+  auto running = end.fRunning - begin.fRunning;
+  if (running == 0) {
+    // the group was not scheduled: the values are unknown
+    values.fill(0);
+    return enabled == 0 ? 1. : 0.;
+  }
+
+  // estimate of the counts over the whole interval
+  auto scale = G4double(enabled)/running;
+  for (G4int i = 0; i < kNofCounters; ++i) {
+    values[i] = static_cast<std::uint64_t>(
+      (end.fValues[i] - begin.fValues[i]) * scale + 0.5);
+  }
+  return enabled > 0 ? G4double(running)/enabled : 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::BeginEvent()
+{
+  if (!IsOpen()) return;
+
+  fSDEvent.fill(0);
+  Read(fEventBegin);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::EndEvent(G4int eventID)
+{
+  if (!IsOpen()) return;
+
+  Sample end;
+  Read(end);
+  Values event;
+  auto running = Difference(fEventBegin, end, event);
+  for (G4int i = 0; i < kNofCounters; ++i) {
+    fEventTotal[i] += event[i];
+    fSDTotal[i] += fSDEvent[i];
+  }
+  ++fNofEvents;
+  if (running < 1.) ++fNofMultiplexed;
+
+  if (fFile) {
+    std::fprintf(fFile, "%d", eventID);
+    for (auto value : event) {
+      std::fprintf(fFile, ",%llu", static_cast<unsigned long long>(value));
+    }
+    for (auto value : fSDEvent) {
+      std::fprintf(fFile, ",%llu", static_cast<unsigned long long>(value));
+    }
+    std::fprintf(fFile, ",%.4f\n", running);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::BeginSD()
+{
+  Read(fSDBegin);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::EndSD()
+{
+  Sample end;
+  Read(end);
+  Values sd;
+  Difference(fSDBegin, end, sd);
+  for (G4int i = 0; i < kNofCounters; ++i) {
+    fSDEvent[i] += sd[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::PrintTotals()
+{
+  std::lock_guard<std::mutex> lock(fgMutex);
+  if (fgNofEvents == 0) return;
+
+  auto ipc = [](const Values& values) { 
+    return values[kCycles] > 0 
+      ? G4double(values[kInstructions])/values[kCycles] : 0.; 
+  };
+  auto perEvent = [](std::uint64_t value) { 
+    return G4double(value)/fgNofEvents; 
+  };
+
+  G4cout
+    << G4endl
+    << "--------------------Performance counters--------------------" << G4endl
+    << " " << fgNofEvents << " events, per event:" << G4endl
+    << "   all : " << perEvent(fgEventTotal[kCycles]) << " cycles, IPC " 
+    << ipc(fgEventTotal) << ", "
+    << perEvent(fgEventTotal[kCacheMisses]) << " cache misses, "
+    << perEvent(fgEventTotal[kBranchMisses]) << " branch misses" << G4endl
+    << "   SD  : " << perEvent(fgSDTotal[kCycles]) << " cycles, IPC " 
+    << ipc(fgSDTotal) << ", "
+    << perEvent(fgSDTotal[kCacheMisses]) << " cache misses, "
+    << perEvent(fgSDTotal[kBranchMisses]) << " branch misses" << G4endl;
+  if (fgNofMultiplexed) {
+    G4cout 
+      << " " << fgNofMultiplexed << " events counted only part of the time "
+      << "(multiplexed PMU), their values are scaled estimates" << G4endl;
+  }
+
+  fgEventTotal.fill(0);
+  fgSDTotal.fill(0);
+  fgNofEvents = 0;
+  fgNofMultiplexed = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PerfCounters::DefineCommands()
+{
+  // Define /B5/profile command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/profile/", 
+                                      "Profiling");
+
+  // perfCounters command
+  auto& countersCmd
+    = fMessenger->DeclareMethod("perfCounters", &B5PerfCounters::SetPrefix,
+        "Count cycles, instructions, cache and branch misses per event\n"
+        "and in the sensitive detectors (Linux only), written to\n"
+        "<prefix>_r<run>_t<thread>.csv; \"none\" switches it off.");
+  countersCmd.SetParameterName("prefix", true);
+  countersCmd.SetDefaultValue("none");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
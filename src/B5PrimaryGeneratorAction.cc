@@ -28,6 +28,7 @@
 /// \brief Implementation of the B5PrimaryGeneratorAction class
 
 #include "B5PrimaryGeneratorAction.hh"
+#include "B5TraceRecorder.hh"
 
 #include "G4Event.hh"
 #include "G4ParticleGun.hh"
@@ -47,7 +48,9 @@ B5PrimaryGeneratorAction::B5PrimaryGeneratorAction()
   fMomentum(1000.*MeV),
   fSigmaMomentum(50.*MeV),
   fSigmaAngle(2.*deg),
-  fRandomizePrimary(true)
+  fRandomizePrimary(true),
+  fTracksPerEvent(1),
+  fTraceRecorder(B5TraceRecorder::Instance())
 {
   G4int nofParticles = 1;
   fParticleGun  = new G4ParticleGun(nofParticles);
@@ -78,6 +81,21 @@ B5PrimaryGeneratorAction::~B5PrimaryGeneratorAction()
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B5PrimaryGeneratorAction::GeneratePrimaries(G4Event* event)
+{
+  fTraceRecorder->BeginEvent();
+
+  // one vertex per track; primaries are tracked with IDs 1..N
+  // in this order (see B5TrackingAction)
+  for (G4int i = 0; i < fTracksPerEvent; ++i) {
+    GenerateTrack(event);
+  }
+
+  fTraceRecorder->EndGeneratePrimaries(event->GetEventID());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5PrimaryGeneratorAction::GenerateTrack(G4Event* event)
 {
   G4ParticleDefinition* particle;  
   if (fRandomizePrimary) {
@@ -165,6 +183,14 @@ void B5PrimaryGeneratorAction::DefineCommands()
   randomCmd.SetGuidance(guidance);
   randomCmd.SetParameterName("flg", true);
   randomCmd.SetDefaultValue("true");
+
+  // tracksPerEvent command
+  auto& tracksCmd
+    = fMessenger->DeclareProperty("tracksPerEvent", fTracksPerEvent, 
+        "Number of primary tracks generated per event.");
+  tracksCmd.SetParameterName("n", true);
+  tracksCmd.SetRange("n>=1");
+  tracksCmd.SetDefaultValue("1");
 }
 
 //..oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5RegionCutMessenger.cc
+/// \brief Implementation of the B5RegionCutMessenger class
+
+#include "B5RegionCutMessenger.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5RegionCutMessenger::B5RegionCutMessenger()
+: G4UImessenger(),
+  fDirectory(nullptr),
+  fCutCmd(nullptr)
+{
+  fDirectory = new G4UIdirectory("/B5/region/");
+  fDirectory->SetGuidance("Region production cuts");
+
+  fCutCmd = new G4UIcommand("/B5/region/cut", this);
+  fCutCmd->SetGuidance("Set the production cut of all particles in a region.");
+  fCutCmd->SetGuidance("Coarse cuts in the absorbers save time in the showers,");
+  fCutCmd->SetGuidance("fine cuts in the tracker gas keep the delta electrons.");
+
+  auto regionParam = new G4UIparameter("region", 's', false);
+  regionParam->SetParameterCandidates("Tracker Scintillator EMCal HadCal");
+  fCutCmd->SetParameter(regionParam);
+
+  auto cutParam = new G4UIparameter("cut", 'd', false);
+  cutParam->SetParameterRange("cut>0.");
+  fCutCmd->SetParameter(cutParam);
+
+  auto unitParam = new G4UIparameter("unit", 's', true);
+  unitParam->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("mm")));
+  unitParam->SetDefaultValue("mm");
+  fCutCmd->SetParameter(unitParam);
+
+  // the regions exist once the geometry is constructed
+  fCutCmd->AvailableForStates(G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5RegionCutMessenger::~B5RegionCutMessenger()
+{
+  delete fCutCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RegionCutMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fCutCmd ) {
+    std::istringstream is(newValue);
+    G4String regionName;
+    G4double value = 0.;
+    G4String unit;
+    is >> regionName >> value >> unit;
+    SetCut(regionName, value*G4UIcommand::ValueOf(unit));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RegionCutMessenger::SetCut(const G4String& regionName, G4double cut)
+{
+  auto regionStore = G4RegionStore::GetInstance();
+  auto region = regionStore->GetRegion(regionName, false);
+  if ( ! region ) {
+    G4ExceptionDescription msg;
+    msg << "Region " << regionName << " not found, the cut is not set.";
+    G4Exception("B5RegionCutMessenger::SetCut()",
+                "B5Code007", JustWarning, msg);
+    return;
+  }
+
+  // After the run initialization the regions without their own cuts
+  // share the default region cuts, which must not be changed here
+  auto defaultCuts 
+    = regionStore->GetRegion("DefaultRegionForTheWorld")->GetProductionCuts();
+  auto cuts = region->GetProductionCuts();
+  if ( ! cuts || cuts == defaultCuts ) {
+    cuts = defaultCuts ? new G4ProductionCuts(*defaultCuts) 
+                       : new G4ProductionCuts();
+    region->SetProductionCuts(cuts);
+  }
+  cuts->SetProductionCut(cut);
+
+  G4cout << "Production cut in region " << regionName << " set to " 
+         << G4BestUnit(cut, "Length") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
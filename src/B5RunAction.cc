@@ -29,29 +29,85 @@
 
 #include "B5RunAction.hh"
 #include "B5EventAction.hh"
+#include "B5SteppingAction.hh"
+#include "B5HoughAccumulator.hh"
+#include "B5HitStreamWriter.hh"
+#include "B5TensorWriter.hh"
+#include "B5FieldSetup.hh"
+#include "B5DetectorConstruction.hh"
+#include "B5Log.hh"
+#include "B5FileManifest.hh"
+#include "B5StackingAction.hh"
+#include "B5StepProfiler.hh"
+#include "B5TraceRecorder.hh"
+#include "B5PerfCounters.hh"
+#include "B5MemoryReport.hh"
 
 #include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "g4analysis.hh"
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Event rates of the threads in the current run, 
+// reported by the workers at the end of their run
+struct ThreadRate 
+{
+  G4int fThreadID;
+  G4int fNofEvents;
+  G4double fSeconds;
+};
+
+std::mutex gRateMutex;
+std::vector<ThreadRate> gThreadRates;
+
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B5RunAction::B5RunAction(B5EventAction* eventAction)
+B5RunAction::B5RunAction(B5EventAction* eventAction, 
+                         B5SteppingAction* steppingAction,
+                         G4bool perWorkerFiles)
  : G4UserRunAction(),
-   fEventAction(eventAction)
+   fEventAction(eventAction),
+   fSteppingAction(steppingAction),
+   fPerWorkerFiles(perWorkerFiles),
+   fMessenger(nullptr),
+   fHitsNtupleID(-1),
+   fConfigID(-1)
 { 
   // Create the analysis manager using a new factory method.
   // The choice of analysis technology is done via the function argument.
   auto analysisManager = G4Analysis::ManagerInstance("root");
-  G4cout << "Using " << analysisManager->GetType() << G4endl;
+  if ( G4Threading::IsMasterThread() ) {
+    G4cout << "Using " << analysisManager->GetType() << G4endl;
+  }
 
   // Default settings
-  analysisManager->SetNtupleMerging(true);
+  // Without merging, the workers write the ntuple in their own files
+  analysisManager->SetNtupleMerging(! fPerWorkerFiles);
      // Note: merging ntuples is available only with Root output
-  analysisManager->SetVerboseLevel(1);
+  // file open/close messages from the master only
+  analysisManager->SetVerboseLevel(G4Threading::IsMasterThread() ? 1 : 0);
   analysisManager->SetFileName("B5");
 
+  // Create the hit stream and tensor writers and the step profiler 
+  // of this thread (and their commands)
+  B5HitStreamWriter::Instance();
+  B5TensorWriter::Instance();
+  B5StepProfiler::Instance();
+  B5TraceRecorder::Instance();
+  B5PerfCounters::Instance();
+  B5MemoryReport::Instance();
+
   // Book histograms, ntuple
   //
   
@@ -70,11 +126,19 @@ B5RunAction::B5RunAction(B5EventAction* eventAction)
   //   ->CreateH2("Chamber2 XY","Drift Chamber 2 X vs Y",           // h2 Id = 1
   //              50, -1500., 1500, 50, -300., 300.);
 
-  analysisManager->CreateH1("HistA","Histogram of A", 300, -1.8, -1.4); 
+  // Pair histograms, merged from B5HoughAccumulator at end of run
+  analysisManager->CreateH1("HistA","Histogram of A", 
+                            kNofHoughABins, kHoughAMin, kHoughAMax); 
   // analysisManager->CreateH1("HistB","Histogram of B", 25, -3000., 50); 
   // analysisManager->CreateH2("HistAB","Histogram of AB", 50, -4., 2, 50, -3000., 50.); 
-  analysisManager->CreateH1("HistB","Histogram of B", 300, -9000., -7000); 
-  analysisManager->CreateH2("HistAB","Histogram of AB", 300, -1.8, -1.4, 300, -9000., -7000.); 
+  analysisManager->CreateH1("HistB","Histogram of B", 
+                            kNofHoughBBins, kHoughBMin, kHoughBMax); 
+  // the pair histogram accumulator of this thread (and its command)
+  // resolves their IDs
+  B5HoughAccumulator::Instance();
+  analysisManager->CreateH2("HistAB","Histogram of AB", 
+                            kNofHoughABins, kHoughAMin, kHoughAMax, 
+                            kNofHoughBBins, kHoughBMin, kHoughBMax); 
 
   // Creating ntuple
   //
@@ -93,23 +157,55 @@ B5RunAction::B5RunAction(B5EventAction* eventAction)
     analysisManager->CreateNtupleDColumn("PositionZ", fEventAction->pos_z_vector); // column Id = 10
     analysisManager->CreateNtupleDColumn("Momentum"); // column Id = 11
     analysisManager->CreateNtupleDColumn("InitAngle"); // column Id = 12
+    analysisManager->CreateNtupleIColumn("TrackIndex", fEventAction->GetTrackIndex()); // column Id = 13
+    analysisManager->CreateNtupleDColumn("TrackInitAngle", fEventAction->GetTrackInitAngle()); // column Id = 14
+    analysisManager->CreateNtupleIColumn("ConfigID"); // column Id = 15
     analysisManager->FinishNtuple();
+
+    // Optional flat hits ntuple: one row per chamber 1 hit, 
+    // scalar float columns (mm, ns, GeV)
+    fHitsNtupleID = analysisManager->CreateNtuple("B5Hits", "Chamber 1 hits");
+    analysisManager->CreateNtupleIColumn("Event");      // column Id = 0
+    analysisManager->CreateNtupleIColumn("Layer");      // column Id = 1
+    analysisManager->CreateNtupleFColumn("X");          // column Id = 2
+    analysisManager->CreateNtupleFColumn("Y");          // column Id = 3
+    analysisManager->CreateNtupleFColumn("Z");          // column Id = 4
+    analysisManager->CreateNtupleFColumn("T");          // column Id = 5
+    analysisManager->CreateNtupleFColumn("P");          // column Id = 6
+    analysisManager->CreateNtupleIColumn("TrackIndex"); // column Id = 7
+    analysisManager->CreateNtupleIColumn("ConfigID");   // column Id = 8
+    analysisManager->FinishNtuple();
+    fEventAction->SetHitsNtupleID(fHitsNtupleID);
+
+    // Only active objects are written: the hits ntuple is off by default
+    analysisManager->SetActivation(true);
+    analysisManager->SetNtupleActivation(fHitsNtupleID, false);
   }
+
+  // define commands for this class
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B5RunAction::~B5RunAction()
 {
+  delete fMessenger;
   delete G4AnalysisManager::Instance();  
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B5RunAction::BeginOfRunAction(const G4Run* /*run*/)
+void B5RunAction::BeginOfRunAction(const G4Run* run)
 { 
   //inform the runManager to save random number seed
   //G4RunManager::GetRunManager()->SetRandomNumberStore(true);
+
+  fStartTime = std::chrono::steady_clock::now();
+
+  auto traceRecorder = B5TraceRecorder::Instance();
+  auto traceBegin = B5TraceRecorder::Now();
+  traceRecorder->Open();
   
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
@@ -118,18 +214,269 @@ void B5RunAction::BeginOfRunAction(const G4Run* /*run*/)
   // The default file name is set in B5RunAction::B5RunAction(),
   // it can be overwritten in a macro
   analysisManager->OpenFile();
+
+  // Rebuild the chord finder of this thread if the field mode changed
+  if ( auto fieldSetup = B5FieldSetup::GetInstance() ) {
+    fieldSetup->Update();
+  }
+
+  // Switch the second arm detectors of this thread for the tracking-only mode
+  auto detector = static_cast<const B5DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  detector->ActivateSensitiveDetectors();
+  if ( fEventAction ) {
+    fEventAction->SetTrackingOnly(detector->IsTrackingOnly());
+    fEventAction->SetConfigID(fConfigID);
+  }
+  if ( fSteppingAction ) {
+    fSteppingAction->BeginOfRun();
+  }
+
+  // Reset the pair histogram bins of this thread
+  B5HoughAccumulator::Instance()->Reset();
+
+  // Open the hit stream and tensor shards of this thread 
+  // (events are processed on workers only in MT mode)
+  if ( ! G4Threading::IsMultithreadedApplication() || 
+       G4Threading::IsWorkerThread() ) {
+    B5HitStreamWriter::Instance()->Open(run->GetRunID());
+    B5TensorWriter::Instance()->Open(run->GetRunID());
+    B5PerfCounters::Instance()->Open(run->GetRunID());
+  }
+
+  B5MemoryReport::Instance()->BeginOfRun(run->GetRunID());
+
+  traceRecorder->Record(B5TraceRecorder::kBeginOfRun, 
+                        traceBegin, B5TraceRecorder::Now());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B5RunAction::EndOfRunAction(const G4Run* /*run*/)
+void B5RunAction::EndOfRunAction(const G4Run* run)
 {
+  auto traceRecorder = B5TraceRecorder::Instance();
+  auto traceBegin = B5TraceRecorder::Now();
+
   // save histograms & ntuple
   //
   auto analysisManager = G4AnalysisManager::Instance();
+
+  // merge the pair histogram bins of this thread 
+  // before the histograms are written (and merged on master)
+  B5HoughAccumulator::Instance()->MergeIntoHistograms();
+
   analysisManager->Write();
   analysisManager->CloseFile();
 
+  // List the per-worker files (workers end their run before the master);
+  // the master writes the manifest and merge script if there is 
+  // anything to merge or recompress
+  if ( fPerWorkerFiles && G4Threading::IsMultithreadedApplication() &&
+       G4Threading::IsWorkerThread() ) {
+    B5FileManifest::Register(
+      B5FileManifest::GetWorkerFileName(analysisManager->GetFileName(),
+                                        G4Threading::G4GetThreadId()));
+  }
+  if ( G4Threading::IsMasterThread() ) {
+    B5FileManifest::Write(analysisManager->GetFileName(), run->GetRunID());
+  }
+
+  // Close the hit stream and tensor shards of this thread; the master 
+  // lists all shards in the manifests (workers end their run before it)
+  B5HitStreamWriter::Instance()->Close();
+  B5TensorWriter::Instance()->Close();
+  if ( G4Threading::IsMasterThread() ) {
+    B5HitStreamWriter::WriteManifest(run->GetRunID());
+    B5TensorWriter::WriteManifest(run->GetRunID());
+  }
+
+  // Stacking rule counters: each thread adds its own to the run total,
+  // the master prints it (workers end their run before it)
+  B5StackingAction::MergeCounters();
+  if ( G4Threading::IsMasterThread() ) {
+    B5StackingAction::PrintCounters();
+  }
+
+  // Step profile: each thread adds its tables, the master writes the report
+  B5StepProfiler::Instance()->Merge();
+  if ( G4Threading::IsMasterThread() ) {
+    B5StepProfiler::WriteReport(run->GetRunID());
+  }
+
+  B5MemoryReport::Instance()->EndOfRun(run->GetRunID());
+
+  // Performance counters: each thread closes its own (adding them to the
+  // totals), the master prints the totals
+  B5PerfCounters::Instance()->Close();
+  if ( G4Threading::IsMasterThread() ) {
+    B5PerfCounters::PrintTotals();
+  }
+
+  // Timeline: each thread adds its spans, the master writes the trace
+  traceRecorder->Record(B5TraceRecorder::kEndOfRun, 
+                        traceBegin, B5TraceRecorder::Now());
+  traceRecorder->Merge();
+  if ( G4Threading::IsMasterThread() ) {
+    B5TraceRecorder::Write(run->GetRunID());
+  }
+
+  // Event rates
+  std::chrono::duration<double> elapsed 
+    = std::chrono::steady_clock::now() - fStartTime;
+  if ( G4Threading::IsMultithreadedApplication() && 
+       G4Threading::IsWorkerThread() ) {
+    std::lock_guard<std::mutex> lock(gRateMutex);
+    gThreadRates.push_back(
+      { G4Threading::G4GetThreadId(), run->GetNumberOfEvent(), elapsed.count() });
+    return;
+  }
+  PrintEventRates(run->GetNumberOfEvent(), elapsed.count());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::PrintEventRates(G4int nofEvents, G4double seconds)
+{
+  std::lock_guard<std::mutex> lock(gRateMutex);
+
+  G4cout
+    << G4endl
+    << "--------------------End of Global Run-----------------------" << G4endl
+    << " " << nofEvents << " events in " << seconds << " s : "
+    << ( seconds > 0. ? nofEvents/seconds : 0. ) << " events/s" << G4endl;
+
+  if ( gThreadRates.size() ) {
+    std::sort(gThreadRates.begin(), gThreadRates.end(), 
+              [](const ThreadRate& a, const ThreadRate& b) 
+              { return a.fThreadID < b.fThreadID; });
+    G4double sum = 0.;
+    G4double min = DBL_MAX;
+    G4double max = 0.;
+    for (const auto& rate : gThreadRates) {
+      auto eventsPerSecond 
+        = rate.fSeconds > 0. ? rate.fNofEvents/rate.fSeconds : 0.;
+      B5_DEBUG("thread %d: %d events in %g s : %g events/s", 
+               rate.fThreadID, rate.fNofEvents, rate.fSeconds, 
+               eventsPerSecond);
+      min = std::min(min, eventsPerSecond);
+      max = std::max(max, eventsPerSecond);
+      sum += eventsPerSecond;
+    }
+    G4cout 
+      << " " << gThreadRates.size() << " threads : " 
+      << sum/gThreadRates.size() << " events/s per thread" 
+      << " (min " << min << ", max " << max << ")" << G4endl;
+  }
+  G4cout 
+    << "------------------------------------------------------------" << G4endl;
+
+  gThreadRates.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::SetHitsNtuple(G4bool active)
+{
+  if ( fHitsNtupleID < 0 ) return;
+  G4AnalysisManager::Instance()->SetNtupleActivation(fHitsNtupleID, active);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::DefineCommands()
+{
+  // Define /B5/output command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/output/", 
+                                      "Output control");
+
+  // hitsNtuple command
+  auto& hitsCmd
+    = fMessenger->DeclareMethod("hitsNtuple", &B5RunAction::SetHitsNtuple,
+        "Write the B5Hits ntuple with one row per chamber 1 hit.");
+  hitsCmd.SetParameterName("active", true);
+  hitsCmd.SetDefaultValue("true");
+
+  // compression command
+  auto& compressionCmd
+    = fMessenger->DeclareMethod("compression", &B5RunAction::SetCompression,
+        "Set the compression algorithm (zlib, lzma, lz4, zstd, none) "
+        "and level (0-9).\n"
+        "Geant4 writes zlib only: other algorithms are applied by the merge "
+        "script\n(the simulation then writes with zlib level 1).");
+  compressionCmd.SetGuidance("Usage: /B5/output/compression <algorithm> <level>");
+
+  // basketSize command
+  auto& basketSizeCmd
+    = fMessenger->DeclareMethod("basketSize", &B5RunAction::SetBasketSize,
+        "Set the ntuple basket size in bytes.");
+  basketSizeCmd.SetParameterName("size", false);
+  basketSizeCmd.SetRange("size>0");
+
+  // autoFlush command
+  auto& autoFlushCmd
+    = fMessenger->DeclareMethod("autoFlush", &B5RunAction::SetAutoFlush,
+        "Set the number of entries per basket (the tools ntuples have no "
+        "AutoFlush clusters,\nthe number of entries written together is "
+        "set per basket).");
+  autoFlushCmd.SetParameterName("entries", false);
+  autoFlushCmd.SetRange("entries>0");
+
+  // configID command
+  auto& configIDCmd
+    = fMessenger->DeclareProperty("configID", fConfigID,
+        "Set the configuration ID written in the ConfigID ntuple columns "
+        "(set per point by /B5/sweep/run, -1 outside of a sweep).");
+  configIDCmd.SetParameterName("id", true);
+  configIDCmd.SetRange("id>=-1");
+  configIDCmd.SetDefaultValue("-1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::SetCompression(G4String algorithm, G4int level)
+{
+  // ROOT compression algorithm codes
+  G4int code = -1;
+  if      ( algorithm == "zlib" ) code = 1;
+  else if ( algorithm == "lzma" ) code = 2;
+  else if ( algorithm == "lz4" )  code = 4;
+  else if ( algorithm == "zstd" ) code = 5;
+  else if ( algorithm == "none" ) code = 0;
+
+  if ( code < 0 || level < 0 || level > 9 ) {
+    G4ExceptionDescription msg;
+    msg << "Unknown compression " << algorithm << " " << level 
+        << ", the setting is ignored." << G4endl;
+    G4Exception("B5RunAction::SetCompression()",
+                "B5Code006", JustWarning, msg);
+    return;
+  }
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  if ( code == 1 || code == 0 ) {
+    analysisManager->SetCompressionLevel(code == 0 ? 0 : level);
+    B5FileManifest::SetCompressionSettings(-1);
+  }
+  else {
+    // fast write, recompressed by the merge script
+    analysisManager->SetCompressionLevel(1);
+    B5FileManifest::SetCompressionSettings(code*100 + level);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::SetBasketSize(G4int size)
+{
+  G4AnalysisManager::Instance()->SetBasketSize(size);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5RunAction::SetAutoFlush(G4int entries)
+{
+  G4AnalysisManager::Instance()->SetBasketEntries(entries);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,420 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5StackingAction.cc
+/// \brief Implementation of the B5StackingAction and B5StackingMessenger classes
+
+#include "B5StackingAction.hh"
+#include "B5TrackInformation.hh"
+#include "B5ThreadClock.hh"
+
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UnitsTable.hh"
+#include "G4ios.hh"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+// Rules as set on master and run totals of their counters
+struct RuleSpec {
+  G4ClassificationOfNewTrack fClassification;
+  G4String fParticleName;
+  G4String fRegionName;
+  G4double fMaxEnergy;
+};
+
+struct RuleTotal {
+  G4long fNofTracks;
+  G4double fEnergy;
+  G4long fNofSteps;
+  G4double fSeconds;
+};
+
+std::vector<RuleSpec> gRuleSpecs;
+std::atomic<G4int> gRulesVersion(0);
+std::vector<RuleTotal> gRuleTotals;
+RuleTotal gOtherTotal = { 0, 0., 0, 0. };
+std::mutex gStackingMutex;
+
+const char* GetActionName(G4ClassificationOfNewTrack classification)
+{
+  switch (classification) {
+    case fKill:    return "kill";
+    case fWaiting: return "postpone";
+    default:       return "keep";
+  }
+}
+
+void PrintRule(std::size_t index, const RuleSpec& rule)
+{
+  G4cout 
+    << std::setw(5) << index << " " 
+    << std::setw(9) << std::left << GetActionName(rule.fClassification)
+    << std::setw(12) << rule.fParticleName 
+    << std::setw(14) << rule.fRegionName << std::right;
+  if ( rule.fMaxEnergy > 0. ) {
+    G4cout << "below " << G4BestUnit(rule.fMaxEnergy, "Energy");
+  } else {
+    G4cout << "all energies";
+  }
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5StackingAction* B5StackingAction::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StackingAction::B5StackingAction()
+: G4UserStackingAction(),
+  fRules(),
+  fRulesVersion(-1),
+  fNofOtherTracks(0),
+  fOtherEnergy(0.),
+  fNofOtherSteps(0),
+  fOtherSeconds(0.)
+{
+  fgInstance = this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StackingAction::~B5StackingAction()
+{
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack 
+B5StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  // primaries are always tracked
+  if ( track->GetParentID() == 0 ) return fUrgent;
+
+  auto energy = track->GetKineticEnergy();
+  const G4Region* region = nullptr;
+  if ( auto volume = track->GetVolume() ) {
+    region = volume->GetLogicalVolume()->GetRegion();
+  }
+
+  // the rule is recorded in the track to attribute its cost
+  auto info = static_cast<B5TrackInformation*>(track->GetUserInformation());
+
+  for (std::size_t i = 0; i < fRules.size(); ++i) {
+    auto& rule = fRules[i];
+    if ( rule.fParticle && rule.fParticle != track->GetDefinition() ) continue;
+    if ( rule.fRegion && rule.fRegion != region ) continue;
+    if ( rule.fMaxEnergy > 0. && energy >= rule.fMaxEnergy ) continue;
+    ++rule.fNofTracks;
+    rule.fEnergy += energy;
+    if ( info ) info->SetStackingRule(G4int(i));
+    return rule.fClassification;
+  }
+
+  ++fNofOtherTracks;
+  fOtherEnergy += energy;
+  if ( info && fRules.size() ) {
+    info->SetStackingRule(B5TrackInformation::kOtherStackingRule);
+  }
+  return fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::AddTrackCost(G4int rule, G4int nofSteps, 
+                                    G4double seconds)
+{
+  if ( rule >= 0 && rule < G4int(fRules.size()) ) {
+    fRules[rule].fNofSteps += nofSteps;
+    fRules[rule].fSeconds += seconds;
+  }
+  else if ( rule == B5TrackInformation::kOtherStackingRule ) {
+    fNofOtherSteps += nofSteps;
+    fOtherSeconds += seconds;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::PrepareNewEvent()
+{
+  if ( fRulesVersion != gRulesVersion ) UpdateRules();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::UpdateRules()
+{
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+
+  auto particleTable = G4ParticleTable::GetParticleTable();
+  auto regionStore = G4RegionStore::GetInstance();
+  fRules.clear();
+  for (const auto& spec : gRuleSpecs) {
+    Rule rule;
+    rule.fClassification = spec.fClassification;
+    rule.fParticle = ( spec.fParticleName == "all" ) 
+      ? nullptr : particleTable->FindParticle(spec.fParticleName);
+    rule.fRegion = ( spec.fRegionName == "all" ) 
+      ? nullptr : regionStore->GetRegion(spec.fRegionName, false);
+    rule.fMaxEnergy = spec.fMaxEnergy;
+    rule.fNofTracks = 0;
+    rule.fEnergy = 0.;
+    rule.fNofSteps = 0;
+    rule.fSeconds = 0.;
+    fRules.push_back(rule);
+  }
+  fRulesVersion = gRulesVersion;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5StackingAction::AddRule(G4ClassificationOfNewTrack classification,
+                                 const G4String& particleName, 
+                                 const G4String& regionName,
+                                 G4double maxEnergy)
+{
+  // the names are checked here, so that the threads can resolve them
+  // without warnings
+  G4ExceptionDescription msg;
+  if ( particleName != "all" && 
+       ! G4ParticleTable::GetParticleTable()->FindParticle(particleName) ) {
+    msg << "Particle " << particleName << " not found.";
+  }
+  if ( regionName != "all" && 
+       ! G4RegionStore::GetInstance()->GetRegion(regionName, false) ) {
+    msg << "Region " << regionName << " not found.";
+  }
+  if ( ! msg.str().empty() ) {
+    msg << " The stacking rule is not added.";
+    G4Exception("B5StackingAction::AddRule()",
+                "B5Code008", JustWarning, msg);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+  gRuleSpecs.push_back({ classification, particleName, regionName, maxEnergy });
+  gRuleTotals.assign(gRuleSpecs.size(), { 0, 0., 0, 0. });
+  ++gRulesVersion;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::ClearRules()
+{
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+  gRuleSpecs.clear();
+  gRuleTotals.clear();
+  ++gRulesVersion;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::ListRules()
+{
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+
+  if ( gRuleSpecs.empty() ) {
+    G4cout << "No stacking rules, all secondaries are kept." << G4endl;
+    return;
+  }
+  G4cout << " rule action   particle    region" << G4endl;
+  for (std::size_t i = 0; i < gRuleSpecs.size(); ++i) {
+    PrintRule(i, gRuleSpecs[i]);
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::MergeCounters()
+{
+  auto instance = fgInstance;
+  if ( ! instance ) return;
+
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+
+  // the rules do not change during a run
+  if ( instance->fRules.size() == gRuleTotals.size() ) {
+    for (std::size_t i = 0; i < gRuleTotals.size(); ++i) {
+      const auto& rule = instance->fRules[i];
+      gRuleTotals[i].fNofTracks += rule.fNofTracks;
+      gRuleTotals[i].fEnergy += rule.fEnergy;
+      gRuleTotals[i].fNofSteps += rule.fNofSteps;
+      gRuleTotals[i].fSeconds += rule.fSeconds;
+    }
+  }
+  gOtherTotal.fNofTracks += instance->fNofOtherTracks;
+  gOtherTotal.fEnergy += instance->fOtherEnergy;
+  gOtherTotal.fNofSteps += instance->fNofOtherSteps;
+  gOtherTotal.fSeconds += instance->fOtherSeconds;
+
+  for (auto& rule : instance->fRules) {
+    rule.fNofTracks = 0;
+    rule.fEnergy = 0.;
+    rule.fNofSteps = 0;
+    rule.fSeconds = 0.;
+  }
+  instance->fNofOtherTracks = 0;
+  instance->fOtherEnergy = 0.;
+  instance->fNofOtherSteps = 0;
+  instance->fOtherSeconds = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingAction::PrintCounters()
+{
+  std::lock_guard<std::mutex> lock(gStackingMutex);
+
+  if ( gRuleSpecs.size() ) {
+    G4cout
+      << G4endl
+      << "--------------------Stacking rules--------------------------" << G4endl;
+    // the cost of the kept and postponed tracks: steps and CPU time
+    auto printTotal = [](const RuleTotal& total) {
+      G4cout 
+        << " : " << total.fNofTracks << " tracks, " 
+        << G4BestUnit(total.fEnergy, "Energy") << ", cost " 
+        << total.fNofSteps << " steps, " << total.fSeconds 
+        << ( kB5ThreadClockIsCpu ? " s CPU" : " s" ) << G4endl;
+    };
+    for (std::size_t i = 0; i < gRuleSpecs.size(); ++i) {
+      PrintRule(i, gRuleSpecs[i]);
+      printTotal(gRuleTotals[i]);
+    }
+    G4cout << "      other secondaries kept";
+    printTotal(gOtherTotal);
+  }
+
+  for (auto& total : gRuleTotals) {
+    total = { 0, 0., 0, 0. };
+  }
+  gOtherTotal = { 0, 0., 0, 0. };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StackingMessenger::B5StackingMessenger()
+: G4UImessenger(),
+  fDirectory(nullptr),
+  fAddRuleCmd(nullptr),
+  fClearRulesCmd(nullptr),
+  fListRulesCmd(nullptr)
+{
+  fDirectory = new G4UIdirectory("/B5/stack/");
+  fDirectory->SetGuidance("Stacking rules for the secondaries");
+
+  fAddRuleCmd = new G4UIcommand("/B5/stack/addRule", this);
+  fAddRuleCmd->SetGuidance("Add a rule for the secondaries.");
+  fAddRuleCmd->SetGuidance("The first matching rule kills the track, postpones it");
+  fAddRuleCmd->SetGuidance("to the waiting stack or keeps it.");
+  fAddRuleCmd->SetGuidance("particle and region may be all, a maxEnergy of 0");
+  fAddRuleCmd->SetGuidance("matches all energies.");
+
+  auto actionParam = new G4UIparameter("action", 's', false);
+  actionParam->SetParameterCandidates("kill postpone keep");
+  fAddRuleCmd->SetParameter(actionParam);
+
+  auto particleParam = new G4UIparameter("particle", 's', false);
+  fAddRuleCmd->SetParameter(particleParam);
+
+  auto regionParam = new G4UIparameter("region", 's', false);
+  fAddRuleCmd->SetParameter(regionParam);
+
+  auto energyParam = new G4UIparameter("maxEnergy", 'd', false);
+  energyParam->SetParameterRange("maxEnergy>=0.");
+  fAddRuleCmd->SetParameter(energyParam);
+
+  auto unitParam = new G4UIparameter("unit", 's', true);
+  unitParam->SetParameterCandidates(
+    G4UIcommand::UnitsList(G4UIcommand::CategoryOf("MeV")));
+  unitParam->SetDefaultValue("MeV");
+  fAddRuleCmd->SetParameter(unitParam);
+
+  // the regions exist once the geometry is constructed
+  fAddRuleCmd->AvailableForStates(G4State_Idle);
+
+  fClearRulesCmd = new G4UIcmdWithoutParameter("/B5/stack/clearRules", this);
+  fClearRulesCmd->SetGuidance("Remove all rules, all secondaries are kept.");
+  fClearRulesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fListRulesCmd = new G4UIcmdWithoutParameter("/B5/stack/listRules", this);
+  fListRulesCmd->SetGuidance("Print the rules in the order of matching.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StackingMessenger::~B5StackingMessenger()
+{
+  delete fAddRuleCmd;
+  delete fClearRulesCmd;
+  delete fListRulesCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StackingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fAddRuleCmd ) {
+    std::istringstream is(newValue);
+    G4String action, particleName, regionName, unit;
+    G4double maxEnergy = 0.;
+    is >> action >> particleName >> regionName >> maxEnergy >> unit;
+    auto classification = fUrgent;
+    if ( action == "kill" ) classification = fKill;
+    if ( action == "postpone" ) classification = fWaiting;
+    B5StackingAction::AddRule(classification, particleName, regionName, 
+                              maxEnergy*G4UIcommand::ValueOf(unit));
+  }
+  else if ( command == fClearRulesCmd ) {
+    B5StackingAction::ClearRules();
+  }
+  else if ( command == fListRulesCmd ) {
+    B5StackingAction::ListRules();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
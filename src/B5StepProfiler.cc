@@ -0,0 +1,211 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5StepProfiler.cc
+/// \brief Implementation of the B5StepProfiler class
+
+#include "B5StepProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5StepProfiler* B5StepProfiler::fgInstance = nullptr;
+std::mutex B5StepProfiler::fgMutex;
+std::map<G4String, B5StepProfiler::Entry> B5StepProfiler::fgVolumes;
+std::map<G4String, B5StepProfiler::Entry> B5StepProfiler::fgParticles;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StepProfiler* B5StepProfiler::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5StepProfiler();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StepProfiler::B5StepProfiler()
+: fMessenger(nullptr), fPrefix(), fEnabled(false),
+  fLastTime(0.), fVolumes(), fParticles()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5StepProfiler::~B5StepProfiler()
+{
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StepProfiler::SetPrefix(const G4String& val)
+{
+  fPrefix = (val == "none") ? G4String() : val;
+  fEnabled = ! fPrefix.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StepProfiler::Step(const G4Step* step)
+{
+  auto now = B5ThreadClockSeconds();
+  auto seconds = now - fLastTime;
+  fLastTime = now;
+
+  auto volume 
+    = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+  auto& volumeEntry = fVolumes[volume];
+  ++volumeEntry.fNofSteps;
+  volumeEntry.fSeconds += seconds;
+
+  auto& particleEntry = fParticles[step->GetTrack()->GetDefinition()];
+  ++particleEntry.fNofSteps;
+  particleEntry.fSeconds += seconds;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StepProfiler::Merge()
+{
+  if (fVolumes.empty()) return;
+
+  std::lock_guard<std::mutex> lock(fgMutex);
+  for (const auto& entry : fVolumes) {
+    auto& total = fgVolumes[entry.first->GetName()];
+    total.fNofSteps += entry.second.fNofSteps;
+    total.fSeconds += entry.second.fSeconds;
+  }
+  for (const auto& entry : fParticles) {
+    auto& total = fgParticles[entry.first->GetParticleName()];
+    total.fNofSteps += entry.second.fNofSteps;
+    total.fSeconds += entry.second.fSeconds;
+  }
+  fVolumes.clear();
+  fParticles.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StepProfiler::WriteReport(G4int runID)
+{
+  std::lock_guard<std::mutex> lock(fgMutex);
+  if (fgVolumes.empty()) return;
+
+  G4long nofSteps = 0;
+  G4double seconds = 0.;
+  for (const auto& entry : fgVolumes) {
+    nofSteps += entry.second.fNofSteps;
+    seconds += entry.second.fSeconds;
+  }
+
+  std::ostringstream fileName;
+  fileName << Instance()->GetPrefix() << "_r" << runID << ".csv";
+  std::ofstream csv(fileName.str());
+  const char* timeName = kB5ThreadClockIsCpu ? "cpuSeconds" : "wallSeconds";
+  csv << "type,name,steps," << timeName << ",stepFraction,timeFraction" 
+      << std::endl;
+
+  G4cout
+    << G4endl
+    << "--------------------Step profile----------------------------" << G4endl
+    << " " << nofSteps << " steps in " << seconds << " s" 
+    << ( kB5ThreadClockIsCpu ? " (thread CPU time)" : " (wall time)" ) 
+    << G4endl;
+
+  using Row = std::pair<G4String, Entry>;
+  for (auto table : { std::make_pair("volume", &fgVolumes), 
+                      std::make_pair("particle", &fgParticles) }) {
+    // sorted by time
+    std::vector<Row> rows(table.second->begin(), table.second->end());
+    std::sort(rows.begin(), rows.end(), 
+              [](const Row& a, const Row& b) 
+              { return a.second.fSeconds > b.second.fSeconds; });
+
+    G4cout 
+      << std::setw(24) << std::left << table.first << std::right
+      << std::setw(12) << "steps" 
+      << std::setw(12) << ( kB5ThreadClockIsCpu ? "cpu s" : "wall s" ) 
+      << std::setw(9) << "steps%" << std::setw(9) << "time%" << G4endl;
+    for (const auto& row : rows) {
+      auto stepFraction 
+        = nofSteps > 0 ? G4double(row.second.fNofSteps)/nofSteps : 0.;
+      auto timeFraction = seconds > 0. ? row.second.fSeconds/seconds : 0.;
+      G4cout 
+        << std::setw(24) << std::left << row.first << std::right
+        << std::setw(12) << row.second.fNofSteps 
+        << std::setw(12) << std::setprecision(4) << row.second.fSeconds
+        << std::setw(9) << std::setprecision(3) << 100.*stepFraction
+        << std::setw(9) << std::setprecision(3) << 100.*timeFraction 
+        << G4endl;
+      csv << table.first << "," << row.first << "," 
+          << row.second.fNofSteps << "," << row.second.fSeconds << ","
+          << stepFraction << "," << timeFraction << std::endl;
+    }
+    table.second->clear();
+  }
+  G4cout << std::setprecision(6);
+
+  G4cout << "Step profile written to " << fileName.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5StepProfiler::DefineCommands()
+{
+  // Define /B5/profile command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/profile/", 
+                                      "Profiling");
+
+  // steps command
+  auto& stepsCmd
+    = fMessenger->DeclareMethod("steps", &B5StepProfiler::SetPrefix,
+        "Count the steps and their CPU time per logical volume and "
+        "particle,\n"
+        "written to <prefix>_r<run>.csv; \"none\" switches it off.");
+  stepsCmd.SetParameterName("prefix", true);
+  stepsCmd.SetDefaultValue("none");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5SteppingAction.cc
+/// \brief Implementation of the B5SteppingAction class
+
+#include "B5SteppingAction.hh"
+#include "B5DetectorConstruction.hh"
+#include "B5StepProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4RunManager.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5SteppingAction::B5SteppingAction()
+: G4UserSteppingAction(),
+  fProfiler(B5StepProfiler::Instance()),
+  fSecondArm(nullptr),
+  fTrackingOnly(false),
+  fProfiling(false)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5SteppingAction::~B5SteppingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SteppingAction::BeginOfRun()
+{
+  // The settings cannot change during a run: they are cached here so that 
+  // the steps cost nothing when both features are off (the default)
+  auto detector = static_cast<const B5DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fTrackingOnly = detector->IsTrackingOnly();
+  fSecondArm = detector->GetSecondArmPhysical();
+  fProfiling = fProfiler->IsEnabled();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if ( fProfiling ) fProfiler->Step(step);
+
+  if ( ! fTrackingOnly ) return;
+
+  // The second arm is the mother of the hodoscope 2 and the calorimeters,
+  // so every track reaching them enters it first
+  auto postStepPoint = step->GetPostStepPoint();
+  if ( postStepPoint->GetStepStatus() != fGeomBoundary ) return;
+  if ( postStepPoint->GetPhysicalVolume() == fSecondArm ) {
+    step->GetTrack()->SetTrackStatus(fStopAndKill);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,375 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5SweepManager.cc
+/// \brief Implementation of the B5SweepManager class
+
+#include "B5SweepManager.hh"
+#include "B5FileManifest.hh"
+#include "B5DetectorConstruction.hh"
+#include "B5MagneticField.hh"
+
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4UImanager.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcommandStatus.hh"
+#include "G4ParticleTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4ios.hh"
+#include "g4analysis.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5SweepManager::B5SweepManager()
+: G4UImessenger(),
+  fPoints(),
+  fDirectory(nullptr),
+  fAddPointCmd(nullptr),
+  fReadFileCmd(nullptr),
+  fClearCmd(nullptr),
+  fListCmd(nullptr),
+  fRunCmd(nullptr)
+{
+  fDirectory = new G4UIdirectory("/B5/sweep/");
+  fDirectory->SetGuidance("Run a grid of configurations in one job");
+
+  fAddPointCmd = new G4UIcommand("/B5/sweep/addPoint", this);
+  fAddPointCmd->SetGuidance("Add a configuration point, its ID is its index.");
+  fAddPointCmd->SetGuidance("Momentum in GeV, field in tesla, arm angle in deg.");
+
+  auto particleParam = new G4UIparameter("particle", 's', false);
+  fAddPointCmd->SetParameter(particleParam);
+
+  auto momentumParam = new G4UIparameter("momentum", 'd', false);
+  momentumParam->SetParameterRange("momentum>=0.");
+  fAddPointCmd->SetParameter(momentumParam);
+
+  auto fieldParam = new G4UIparameter("field", 'd', false);
+  fAddPointCmd->SetParameter(fieldParam);
+
+  auto angleParam = new G4UIparameter("armAngle", 'd', false);
+  angleParam->SetParameterRange("armAngle>=0. && armAngle<180.");
+  fAddPointCmd->SetParameter(angleParam);
+
+  auto eventsParam = new G4UIparameter("events", 'i', false);
+  eventsParam->SetParameterRange("events>0");
+  fAddPointCmd->SetParameter(eventsParam);
+
+  fReadFileCmd = new G4UIcmdWithAString("/B5/sweep/readFile", this);
+  fReadFileCmd->SetGuidance("Add the points of a text file, one per line:");
+  fReadFileCmd->SetGuidance("  particle momentum(GeV) field(tesla) armAngle(deg) events");
+  fReadFileCmd->SetGuidance("Empty lines and lines starting with # are skipped.");
+  fReadFileCmd->SetParameterName("fileName", false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/B5/sweep/clear", this);
+  fClearCmd->SetGuidance("Remove all points.");
+
+  fListCmd = new G4UIcmdWithoutParameter("/B5/sweep/list", this);
+  fListCmd->SetGuidance("Print the points in their run order.");
+
+  fRunCmd = new G4UIcmdWithoutParameter("/B5/sweep/run", this);
+  fRunCmd->SetGuidance("Run all points, ordered by arm angle and field.");
+  fRunCmd->SetGuidance("The output of each point is written in <name>_c<ID>.root");
+  fRunCmd->SetGuidance("and the points are listed in <name>_sweep.csv.");
+  // the geometry and physics are initialised once for all points
+  fRunCmd->AvailableForStates(G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5SweepManager::~B5SweepManager()
+{
+  delete fAddPointCmd;
+  delete fReadFileCmd;
+  delete fClearCmd;
+  delete fListCmd;
+  delete fRunCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SweepManager::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fAddPointCmd ) {
+    std::istringstream is(newValue);
+    G4String particle;
+    G4double momentum = 0.;
+    G4double field = 0.;
+    G4double armAngle = 0.;
+    G4int nofEvents = 0;
+    is >> particle >> momentum >> field >> armAngle >> nofEvents;
+    AddPoint(particle, momentum*GeV, field*tesla, armAngle*deg, nofEvents);
+  }
+  else if ( command == fReadFileCmd ) {
+    ReadFile(newValue);
+  }
+  else if ( command == fClearCmd ) {
+    Clear();
+  }
+  else if ( command == fListCmd ) {
+    List();
+  }
+  else if ( command == fRunCmd ) {
+    Run();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SweepManager::AddPoint(const G4String& particle, G4double momentum, 
+                              G4double field, G4double armAngle, 
+                              G4int nofEvents)
+{
+  if ( ! G4ParticleTable::GetParticleTable()->FindParticle(particle) ) {
+    G4ExceptionDescription msg;
+    msg << "Particle " << particle << " not found, the point is not added.";
+    G4Exception("B5SweepManager::AddPoint()",
+                "B5Code010", JustWarning, msg);
+    return;
+  }
+
+  fPoints.push_back({ particle, momentum, field, armAngle, nofEvents });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SweepManager::ReadFile(const G4String& fileName)
+{
+  std::ifstream file(fileName);
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << ", no points are added.";
+    G4Exception("B5SweepManager::ReadFile()",
+                "B5Code010", JustWarning, msg);
+    return;
+  }
+
+  std::string line;
+  G4int lineNumber = 0;
+  while ( std::getline(file, line) ) {
+    ++lineNumber;
+    std::istringstream is(line);
+    G4String particle;
+    if ( ! (is >> particle) || particle[0] == '#' ) continue;
+
+    G4double momentum = 0.;
+    G4double field = 0.;
+    G4double armAngle = 0.;
+    G4int nofEvents = 0;
+    if ( ! (is >> momentum >> field >> armAngle >> nofEvents) || 
+         momentum < 0. || armAngle < 0. || armAngle >= 180. || 
+         nofEvents <= 0 ) {
+      G4ExceptionDescription msg;
+      msg << fileName << ":" << lineNumber << ": invalid point \"" 
+          << line << "\", it is skipped.";
+      G4Exception("B5SweepManager::ReadFile()",
+                  "B5Code010", JustWarning, msg);
+      continue;
+    }
+    AddPoint(particle, momentum*GeV, field*tesla, armAngle*deg, nofEvents);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<std::size_t> B5SweepManager::GetRunOrder() const
+{
+  // Changing the arm angle modifies the geometry, which is then 
+  // re-optimised at the next run; the field and the primaries are 
+  // changed between runs at no cost
+  std::vector<std::size_t> order(fPoints.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+    [this](std::size_t a, std::size_t b) {
+      const auto& pa = fPoints[a];
+      const auto& pb = fPoints[b];
+      if ( pa.fArmAngle != pb.fArmAngle ) return pa.fArmAngle < pb.fArmAngle;
+      return pa.fField < pb.fField;
+    });
+  return order;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SweepManager::List() const
+{
+  G4cout << "--------------------Sweep points (run order)--------------------" 
+         << G4endl
+         << std::setw(6) << "ID" << std::setw(12) << "particle" 
+         << std::setw(14) << "p [GeV]" << std::setw(12) << "B [T]"
+         << std::setw(12) << "angle [deg]" << std::setw(10) << "events" 
+         << G4endl;
+  for ( auto i : GetRunOrder() ) {
+    const auto& point = fPoints[i];
+    G4cout << std::setw(6) << i << std::setw(12) << point.fParticle
+           << std::setw(14) << point.fMomentum/GeV 
+           << std::setw(12) << point.fField/tesla
+           << std::setw(12) << point.fArmAngle/deg 
+           << std::setw(10) << point.fNofEvents << G4endl;
+  }
+  G4cout << "----------------------------------------------------------------" 
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5SweepManager::Apply(const G4String& command) const
+{
+  auto status = G4UImanager::GetUIpointer()->ApplyCommand(command);
+  if ( status != fCommandSucceeded ) {
+    G4ExceptionDescription msg;
+    msg << "Command \"" << command << "\" failed (status " << status << ").";
+    G4Exception("B5SweepManager::Run()",
+                "B5Code010", JustWarning, msg);
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5SweepManager::Run()
+{
+  if ( fPoints.empty() ) {
+    G4cout << "No sweep points defined." << G4endl;
+    return;
+  }
+
+  List();
+
+  // The settings changed by the sweep, restored at the end.
+  // The generator exists on workers only: its settings are read with 
+  // the current values of its commands (the momentum in MeV)
+  auto uiManager = G4UImanager::GetUIpointer();
+  auto detector = static_cast<const B5DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  auto savedArmAngle = detector->GetArmAngle();
+  auto field = detector->GetMagneticField();
+  auto savedField = field ? field->GetField() : 0.;
+  G4String savedParticle = uiManager->GetCurrentValues("/gun/particle");
+  G4String savedMomentum 
+    = uiManager->GetCurrentValues("/B5/generator/momentum");
+  G4String savedRandomize 
+    = uiManager->GetCurrentValues("/B5/generator/randomizePrimary");
+  G4String savedConfigID = uiManager->GetCurrentValues("/B5/output/configID");
+
+  // The output file of each point is named after the current file name
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4String fileName = analysisManager->GetFileName();
+  auto baseName = B5FileManifest::GetBaseName(fileName);
+
+  std::ofstream table(baseName + "_sweep.csv");
+  table << "ConfigID,Particle,Momentum_GeV,Field_T,ArmAngle_deg,Events,"
+        << "RunID,File" << std::endl;
+
+  std::ostringstream command;
+  auto setCommand = [&command]() -> std::ostringstream& {
+    command.str("");
+    command << std::setprecision(10);
+    return command;
+  };
+
+  // the primaries are set with /gun/particle for all points
+  G4bool ok = Apply("/B5/generator/randomizePrimary false");
+
+  G4double armAngle = savedArmAngle;
+  for ( auto i : GetRunOrder() ) {
+    if ( ! ok ) break;
+
+    const auto& point = fPoints[i];
+    auto pointFileName = baseName + "_c" + std::to_string(i);
+
+    G4cout << "### Sweep point " << i << ": " << point.fParticle << " " 
+           << G4BestUnit(point.fMomentum, "Energy") << "/c, B = " 
+           << point.fField/tesla << " T, arm angle " 
+           << point.fArmAngle/deg << " deg, " 
+           << point.fNofEvents << " events" << G4endl;
+
+    // the geometry is changed only when the arm angle changes
+    if ( point.fArmAngle != armAngle ) {
+      setCommand() << "/B5/detector/armAngle " << point.fArmAngle/deg << " deg";
+      ok = Apply(command.str());
+      armAngle = point.fArmAngle;
+    }
+    setCommand() << "/B5/field/value " << point.fField/tesla << " tesla";
+    ok = ok && Apply(command.str());
+    ok = ok && Apply("/gun/particle " + point.fParticle);
+    setCommand() << "/B5/generator/momentum " << point.fMomentum/GeV << " GeV";
+    ok = ok && Apply(command.str());
+    ok = ok && Apply("/B5/output/configID " + std::to_string(i));
+    ok = ok && Apply("/analysis/setFileName " + pointFileName);
+    ok = ok && Apply("/run/beamOn " + std::to_string(point.fNofEvents));
+    if ( ! ok ) break;
+
+    auto run = G4RunManager::GetRunManager()->GetCurrentRun();
+    table << i << "," << point.fParticle << "," 
+          << point.fMomentum/GeV << "," << point.fField/tesla << ","
+          << point.fArmAngle/deg << "," << point.fNofEvents << ","
+          << ( run ? run->GetRunID() : -1 ) << "," 
+          << pointFileName << ".root" << std::endl;
+  }
+
+  if ( ! ok ) {
+    G4cout << "The sweep is stopped." << G4endl;
+  }
+
+  // Restore the settings, also after a failure
+  if ( armAngle != savedArmAngle ) {
+    setCommand() << "/B5/detector/armAngle " << savedArmAngle/deg << " deg";
+    Apply(command.str());
+  }
+  if ( field ) {
+    setCommand() << "/B5/field/value " << savedField/tesla << " tesla";
+    Apply(command.str());
+  }
+  if ( ! savedParticle.empty() ) Apply("/gun/particle " + savedParticle);
+  if ( ! savedMomentum.empty() ) {
+    Apply("/B5/generator/momentum " + savedMomentum + " MeV");
+  }
+  if ( ! savedRandomize.empty() ) {
+    Apply("/B5/generator/randomizePrimary " + savedRandomize);
+  }
+  Apply("/B5/output/configID " 
+        + ( savedConfigID.empty() ? G4String("-1") : savedConfigID ));
+  Apply("/analysis/setFileName " + fileName);
+
+  G4cout << "Sweep points written in " << baseName << "_sweep.csv" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,263 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TensorWriter.cc
+/// \brief Implementation of the B5TensorWriter class
+
+#include "B5TensorWriter.hh"
+#include "B5ByteOrder.hh"
+#include "B5Log.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5TensorWriter* B5TensorWriter::fgInstance = nullptr;
+std::mutex B5TensorWriter::fgShardMutex;
+std::vector<std::pair<G4String, G4long>> B5TensorWriter::fgShards;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TensorWriter* B5TensorWriter::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5TensorWriter();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TensorWriter::B5TensorWriter()
+: fMessenger(nullptr), fPrefix(), fNofTimeSteps(10), fChunkSize(4096),
+  fFile(nullptr), fFileName(), fNofSamples(0), fNofSkipped(0),
+  fSample(), fNofSteps(0), fChunk(), fNofChunkSamples(0)
+{
+  // define commands for this class
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TensorWriter::~B5TensorWriter()
+{
+  Close();
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::SetPrefix(const G4String& val)
+{
+  fPrefix = (val == "none") ? G4String() : val;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::Open(G4int runID)
+{
+  if (!IsEnabled() || IsOpen()) return;
+
+  auto threadID = G4Threading::G4GetThreadId();
+  std::ostringstream fileName;
+  fileName << fPrefix << "_r" << runID << "_t" << (threadID < 0 ? 0 : threadID) 
+           << ".tensor";
+  fFileName = fileName.str();
+
+  fFile = std::fopen(fFileName.c_str(), "wb");
+  if (!fFile) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open tensor file " << fFileName << G4endl;
+    G4Exception("B5TensorWriter::Open()",
+                "B5Code005", JustWarning, msg);
+    return;
+  }
+
+  // header, the number of samples is written on close
+  unsigned char header[kHeaderSize];
+  std::memset(header, 0, sizeof(header));
+  std::memcpy(header, "B5TS", 4);
+  B5PutUInt32(header + 4, 1);
+  B5PutUInt32(header + 8, fNofTimeSteps);
+  B5PutUInt32(header + 12, kNofInputs);
+  B5PutUInt32(header + 16, fChunkSize);
+  std::fwrite(header, 1, sizeof(header), fFile);
+
+  auto sampleSize = fNofTimeSteps*kNofInputs + 1;
+  fSample.assign(sampleSize, 0.f);
+  fChunk.resize(std::size_t(fChunkSize)*sampleSize*sizeof(float));
+  fNofChunkSamples = 0;
+  fNofSteps = 0;
+  fNofSamples = 0;
+  fNofSkipped = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::Close()
+{
+  if (!IsOpen()) return;
+
+  WriteChunk();
+
+  unsigned char nofSamples[8];
+  B5PutUInt64(nofSamples, fNofSamples);
+  std::fseek(fFile, 24, SEEK_SET);
+  std::fwrite(nofSamples, 1, sizeof(nofSamples), fFile);
+  std::fclose(fFile);
+  fFile = nullptr;
+
+  B5_INFO("%s: %ld samples, %ld tracks skipped", 
+          fFileName.c_str(), fNofSamples, fNofSkipped);
+
+  {
+    std::lock_guard<std::mutex> lock(fgShardMutex);
+    fgShards.emplace_back(fFileName, fNofSamples);
+  }
+
+  // release the buffers
+  std::vector<float>().swap(fSample);
+  std::vector<unsigned char>().swap(fChunk);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::BeginSample()
+{
+  fNofSteps = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B5TensorWriter::AddStep(G4double x, G4double z)
+{
+  // returns false once the sample is complete
+  if (fNofSteps >= fNofTimeSteps) return false;
+
+  fSample[fNofSteps*kNofInputs] = x/mm;
+  fSample[fNofSteps*kNofInputs + 1] = z/mm;
+  ++fNofSteps;
+  return fNofSteps < fNofTimeSteps;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::EndSample(G4double label)
+{
+  if (!IsOpen()) return;
+
+  if (fNofSteps < fNofTimeSteps) {
+    ++fNofSkipped;
+    return;
+  }
+  fSample.back() = label;
+
+  auto out = fChunk.data() + fNofChunkSamples*fSample.size()*sizeof(float);
+  for (auto value : fSample) {
+    B5PutFloat(out, value);
+    out += sizeof(float);
+  }
+  ++fNofSamples;
+  if (++fNofChunkSamples == fChunkSize) WriteChunk();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::WriteChunk()
+{
+  if (fNofChunkSamples == 0) return;
+
+  std::fwrite(fChunk.data(), sizeof(float)*fSample.size(), 
+              fNofChunkSamples, fFile);
+  fNofChunkSamples = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::WriteManifest(G4int runID)
+{
+  std::lock_guard<std::mutex> lock(fgShardMutex);
+  if (fgShards.empty()) return;
+
+  auto writer = Instance();
+  std::ostringstream fileName;
+  fileName << writer->GetPrefix() << "_r" << runID << ".tensor.manifest";
+  std::ofstream manifest(fileName.str());
+  manifest << "# B5 training tensor manifest" << std::endl
+           << "format B5TS 1" << std::endl
+           << "shape " << writer->fNofTimeSteps << " " << kNofInputs 
+           << std::endl;
+  for (const auto& shard : fgShards) {
+    manifest << "shard " << shard.first << " " << shard.second << std::endl;
+  }
+  fgShards.clear();
+
+  G4cout << "Tensor manifest written to " << fileName.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TensorWriter::DefineCommands()
+{
+  // Define /B5/output command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/output/", 
+                                      "Output control");
+
+  // tensor command
+  auto& tensorCmd
+    = fMessenger->DeclareMethod("tensor", &B5TensorWriter::SetPrefix,
+        "Write training tensors to per-thread shards\n"
+        "<prefix>_r<run>_t<thread>.tensor; \"none\" switches it off.");
+  tensorCmd.SetParameterName("prefix", true);
+  tensorCmd.SetDefaultValue("none");
+
+  // tensorTimeSteps command
+  auto& timeStepsCmd
+    = fMessenger->DeclareProperty("tensorTimeSteps", fNofTimeSteps,
+        "Number of hits (time steps) per training sample.");
+  timeStepsCmd.SetParameterName("ntime", true);
+  timeStepsCmd.SetRange("ntime>=1");
+  timeStepsCmd.SetDefaultValue("10");
+
+  // tensorChunk command
+  auto& chunkCmd
+    = fMessenger->DeclareProperty("tensorChunk", fChunkSize,
+        "Number of samples per written chunk.");
+  chunkCmd.SetParameterName("n", true);
+  chunkCmd.SetRange("n>=1");
+  chunkCmd.SetDefaultValue("4096");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,268 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TraceRecorder.cc
+/// \brief Implementation of the B5TraceRecorder class
+
+#include "B5TraceRecorder.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace {
+
+const char* kPhaseNames[B5TraceRecorder::kNofPhases] = {
+  "event", "generate primaries", "tracking", "SD end of event",
+  "histogram fill", "ntuple fill", "hit stream/tensor write", 
+  "begin of run", "end of run"
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal B5TraceRecorder* B5TraceRecorder::fgInstance = nullptr;
+std::mutex B5TraceRecorder::fgMutex;
+std::vector<B5TraceRecorder::Span> B5TraceRecorder::fgSpans;
+G4long B5TraceRecorder::fgNofLost = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TraceRecorder* B5TraceRecorder::Instance()
+{
+  if (!fgInstance) {
+    fgInstance = new B5TraceRecorder();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TraceRecorder::B5TraceRecorder()
+: fMessenger(nullptr), fPrefix(), fEnabled(false), fBufferSize(100000),
+  fRing(), fNofSpans(0), fThread(0),
+  fEventID(-1), fEventBegin(0), fTrackingBegin(0), fTrackEnd(0),
+  fEndOfEventBegin(0), fHistogramEnd(0), fNtupleEnd(0)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TraceRecorder::~B5TraceRecorder()
+{
+  delete fMessenger;
+  if (fgInstance == this) fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::SetPrefix(const G4String& val)
+{
+  fPrefix = (val == "none") ? G4String() : val;
+  fEnabled = ! fPrefix.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::Open()
+{
+  // the master (or the sequential run) is shown as thread 0
+  fThread = G4Threading::G4GetThreadId() + 1;
+  fNofSpans = 0;
+  if (fEnabled) {
+    fRing.assign(fBufferSize, Span());
+  } else {
+    std::vector<Span>().swap(fRing);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::Record(Phase phase, G4long begin, G4long end, 
+                             G4int eventID)
+{
+  if (!fEnabled || fRing.empty()) return;
+
+  // overwrite the oldest span when full
+  fRing[fNofSpans % fRing.size()] = { phase, fThread, eventID, begin, end };
+  ++fNofSpans;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::EndGeneratePrimaries(G4int eventID)
+{
+  if (!fEnabled) return;
+
+  fEventID = eventID;
+  Record(kGeneratePrimaries, fEventBegin, Now(), fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::BeginEndOfEvent()
+{
+  if (!fEnabled) return;
+
+  fEndOfEventBegin = Now();
+  Record(kTracking, fTrackingBegin, fTrackEnd, fEventID);
+  Record(kSDEndOfEvent, fTrackEnd, fEndOfEventBegin, fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::EndHistogramFill()
+{
+  if (!fEnabled) return;
+
+  fHistogramEnd = Now();
+  Record(kHistogramFill, fEndOfEventBegin, fHistogramEnd, fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::EndNtupleFill()
+{
+  if (!fEnabled) return;
+
+  fNtupleEnd = Now();
+  Record(kNtupleFill, fHistogramEnd, fNtupleEnd, fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::EndOutputWrite()
+{
+  if (!fEnabled) return;
+
+  auto end = Now();
+  Record(kOutputWrite, fNtupleEnd, end, fEventID);
+  Record(kEvent, fEventBegin, end, fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::Merge()
+{
+  if (fNofSpans == 0) return;
+
+  // the ring keeps the last spans, oldest first from the write position
+  G4long size = fRing.size();
+  auto nofKept = std::min(fNofSpans, size);
+  auto first = fNofSpans - nofKept;
+
+  std::lock_guard<std::mutex> lock(fgMutex);
+  for (G4long i = first; i < fNofSpans; ++i) {
+    fgSpans.push_back(fRing[i % size]);
+  }
+  fgNofLost += first;
+  fNofSpans = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::Write(G4int runID)
+{
+  std::lock_guard<std::mutex> lock(fgMutex);
+  if (fgSpans.empty()) return;
+
+  // time stamps in us from the first span
+  G4long origin = fgSpans.front().fBegin;
+  std::set<G4int> threads;
+  for (const auto& span : fgSpans) {
+    origin = std::min(origin, span.fBegin);
+    threads.insert(span.fThread);
+  }
+
+  std::ostringstream fileName;
+  fileName << Instance()->GetPrefix() << "_r" << runID << ".json";
+  std::ofstream json(fileName.str());
+  json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+  for (auto thread : threads) {
+    json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" 
+         << thread << ",\"args\":{\"name\":\"" 
+         << (thread == 0 ? "master" : "worker " + std::to_string(thread - 1))
+         << "\"}}," << std::endl;
+  }
+  json << std::fixed;
+  json.precision(3);
+  for (std::size_t i = 0; i < fgSpans.size(); ++i) {
+    const auto& span = fgSpans[i];
+    json << "{\"name\":\"" << kPhaseNames[span.fPhase] 
+         << "\",\"cat\":\"B5\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.fThread
+         << ",\"ts\":" << (span.fBegin - origin)*1e-3 
+         << ",\"dur\":" << (span.fEnd - span.fBegin)*1e-3;
+    if (span.fEventID >= 0) {
+      json << ",\"args\":{\"event\":" << span.fEventID << "}";
+    }
+    json << "}" << (i + 1 < fgSpans.size() ? "," : "") << std::endl;
+  }
+  json << "]}" << std::endl;
+
+  G4cout << "Trace of " << fgSpans.size() << " spans written to " 
+         << fileName.str() << G4endl;
+  if (fgNofLost) {
+    G4cout << " (" << fgNofLost << " older spans overwritten, "
+           << "see /B5/profile/traceBuffer)" << G4endl;
+  }
+  fgSpans.clear();
+  fgNofLost = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TraceRecorder::DefineCommands()
+{
+  // Define /B5/profile command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, 
+                                      "/B5/profile/", 
+                                      "Profiling");
+
+  // trace command
+  auto& traceCmd
+    = fMessenger->DeclareMethod("trace", &B5TraceRecorder::SetPrefix,
+        "Record the event phases of each thread and write them as a\n"
+        "Chrome trace to <prefix>_r<run>.json; \"none\" switches it off.");
+  traceCmd.SetParameterName("prefix", true);
+  traceCmd.SetDefaultValue("none");
+
+  // traceBuffer command
+  auto& bufferCmd
+    = fMessenger->DeclareProperty("traceBuffer", fBufferSize,
+        "Number of spans kept per thread, the oldest are overwritten.");
+  bufferCmd.SetParameterName("size", true);
+  bufferCmd.SetRange("size>0");
+  bufferCmd.SetDefaultValue("100000");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B5TrackingAction.cc
+/// \brief Implementation of the B5TrackingAction class
+
+#include "B5TrackingAction.hh"
+#include "B5TrackInformation.hh"
+#include "B5StepProfiler.hh"
+#include "B5TraceRecorder.hh"
+#include "B5StackingAction.hh"
+#include "B5ThreadClock.hh"
+
+#include "G4Track.hh"
+#include "G4TrackingManager.hh"
+#include "G4TrackVector.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TrackingAction::B5TrackingAction()
+: G4UserTrackingAction(),
+  fProfiler(B5StepProfiler::Instance()),
+  fTraceRecorder(B5TraceRecorder::Instance()),
+  fTrackStartTime(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B5TrackingAction::~B5TrackingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+  if ( fProfiler->IsEnabled() ) fProfiler->StartTrack();
+
+  // Primaries get the track IDs 1..N in the order they were generated
+  if ( track->GetParentID() == 0 && ! track->GetUserInformation() ) {
+    track->SetUserInformation(
+      new B5TrackInformation(track->GetTrackID() - 1));
+    return;
+  }
+
+  // the clock is read only for tracks classified by a stacking rule
+  auto info 
+    = static_cast<B5TrackInformation*>(track->GetUserInformation());
+  if ( info && info->GetStackingRule() != B5TrackInformation::kNoStackingRule ) {
+    fTrackStartTime = B5ThreadClockSeconds();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B5TrackingAction::PostUserTrackingAction(const G4Track* track)
+{
+  fTraceRecorder->EndTrack();
+
+  auto info 
+    = static_cast<B5TrackInformation*>(track->GetUserInformation());
+  if ( ! info ) return;
+
+  auto rule = info->GetStackingRule();
+  if ( rule != B5TrackInformation::kNoStackingRule ) {
+    B5StackingAction::Instance()->AddTrackCost(rule, 
+      track->GetCurrentStepNumber(), B5ThreadClockSeconds() - fTrackStartTime);
+  }
+
+  auto secondaries = fpTrackingManager->GimmeSecondaries();
+  if ( ! secondaries ) return;
+
+  for (auto secondary : *secondaries) {
+    if ( secondary->GetUserInformation() ) continue;
+    secondary->SetUserInformation(new B5TrackInformation(*info));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......